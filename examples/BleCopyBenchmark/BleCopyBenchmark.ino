@@ -0,0 +1,139 @@
+// This benchmark compares BLE packet paths against a mocked NimBLE layer, so that it does not
+// need a BLE central. It measures the copies made between the ATT buffer and the Face.
+
+#include <esp8266ndn.h>
+
+#include <string>
+
+const int N_PACKETS = 20000;
+const size_t PKT_LENS[]{20, 244, 512};
+
+/** @brief Expose BleServerTransportBase RX path without a BLE stack. */
+class MockTransport : public esp8266ndn::BleServerTransportBase {
+public:
+  MockTransport()
+    : BleServerTransportBase(512, 1) {
+    setRxCallback(countRx, this);
+  }
+
+  void receive(const uint8_t* pkt, size_t pktLen) {
+    handleReceive(pkt, pktLen, 1);
+  }
+
+  uint32_t nRx = 0;
+
+private:
+  static void countRx(void* self, const uint8_t*, size_t, uint64_t) {
+    ++static_cast<MockTransport*>(self)->nRx;
+  }
+
+  bool doIsUp() const final {
+    return true;
+  }
+
+  bool doSend(const uint8_t*, size_t, uint64_t) final {
+    return true;
+  }
+};
+MockTransport transport;
+
+/** @brief Mimic a NimBLE characteristic that stores its value and converts it to an mbuf. */
+class MockCharacteristic {
+public:
+  /** @brief Store the value, as NimBLECharacteristic::setValue does. */
+  void setValue(const uint8_t* value, size_t len) {
+    m_value.assign(reinterpret_cast<const char*>(value), len);
+  }
+
+  /** @brief Return a copy of the stored value, as NimBLECharacteristic::getValue does. */
+  std::string getValue() const {
+    return m_value;
+  }
+
+  /** @brief Notify the stored value. */
+  bool notify() {
+    return notify(reinterpret_cast<const uint8_t*>(m_value.data()), m_value.size());
+  }
+
+  /** @brief Notify a value in caller's buffer, copying it into an mbuf. */
+  bool notify(const uint8_t* value, size_t len) {
+    std::copy_n(value, len, m_mbuf);
+    return m_mbuf[0] == value[0];
+  }
+
+private:
+  std::string m_value;
+  uint8_t m_mbuf[512];
+};
+MockCharacteristic chr;
+
+uint8_t flat[512]; // ATT request flattened by NimBLE
+
+/** @brief RX via stored value: flat buffer -> stored value -> getValue() copy -> RX queue. */
+void
+rxStoredValue(size_t len) {
+  chr.setValue(flat, len);
+  auto value = chr.getValue();
+  transport.receive(reinterpret_cast<const uint8_t*>(value.data()), value.size());
+  transport.loop();
+}
+
+/** @brief RX via writeEvent override: flat buffer -> RX queue. */
+void
+rxDirect(size_t len) {
+  transport.receive(flat, len);
+  transport.loop();
+}
+
+/** @brief TX via stored value: packet -> stored value -> mbuf. */
+void
+txStoredValue(size_t len) {
+  chr.setValue(flat, len);
+  chr.notify();
+}
+
+/** @brief TX from caller's buffer: packet -> mbuf. */
+void
+txDirect(size_t len) {
+  chr.notify(flat, len);
+}
+
+void
+measure(const char* title, void (*f)(size_t), size_t len) {
+  unsigned long t0 = micros();
+  for (int i = 0; i < N_PACKETS; ++i) {
+    f(len);
+  }
+  unsigned long t1 = micros();
+
+  Serial.print(title);
+  Serial.print(F(" len="));
+  Serial.print(len);
+  Serial.print(' ');
+  Serial.print(1000.0 * (t1 - t0) / N_PACKETS);
+  Serial.println(F(" ns/pkt"));
+}
+
+void
+setup() {
+  Serial.begin(115200);
+  Serial.println();
+  esp8266ndn::setLogOutput(Serial);
+
+  for (size_t i = 0; i < sizeof(flat); ++i) {
+    flat[i] = static_cast<uint8_t>(i);
+  }
+}
+
+void
+loop() {
+  for (size_t len : PKT_LENS) {
+    measure("RX stored-value", rxStoredValue, len);
+    measure("RX direct      ", rxDirect, len);
+    measure("TX stored-value", txStoredValue, len);
+    measure("TX direct      ", txDirect, len);
+  }
+  Serial.print(F("received "));
+  Serial.println(transport.nRx);
+  delay(10000);
+}
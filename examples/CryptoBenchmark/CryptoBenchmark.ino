@@ -0,0 +1,286 @@
+// This benchmark measures cryptographic primitives through the ndnph::port layer,
+// after verifying them against known answers.
+
+#include <esp8266ndn.h>
+
+/** @brief Yield at least this often, so that ECDSA runs do not trip the ESP8266 watchdog. */
+const unsigned long YIELD_INTERVAL = 100000;
+
+/**
+ * @brief Run a function repeatedly and print time per iteration.
+ *
+ * Time spent in yield() is excluded.
+ */
+template<typename F>
+void
+measure(const char* title, int n, size_t bytesPerIteration, const F& f) {
+  unsigned long elapsed = 0;
+  unsigned long t0 = micros();
+  for (int i = 0; i < n; ++i) {
+    f();
+    unsigned long t1 = micros();
+    if (t1 - t0 >= YIELD_INTERVAL) {
+      elapsed += t1 - t0;
+      yield();
+      t0 = micros();
+    }
+  }
+  elapsed += micros() - t0;
+
+  Serial.print(title);
+  Serial.print(' ');
+  Serial.print(static_cast<double>(elapsed) / n);
+  Serial.print(F(" us/op"));
+  if (bytesPerIteration > 0) {
+    Serial.print(' ');
+    Serial.print(1000.0 * bytesPerIteration * n / elapsed);
+    Serial.print(F(" KB/s"));
+  }
+  Serial.println();
+}
+
+void
+printResult(const char* title, bool ok) {
+  Serial.print(title);
+  Serial.println(ok ? F(" OK") : F(" FAIL"));
+  yield();
+}
+
+/** @brief FIPS 180-2 SHA-256 test vectors. */
+struct Sha256Vector {
+  const char* input;
+  size_t repeat;
+  uint8_t digest[NDNPH_SHA256_LEN];
+};
+const Sha256Vector SHA256_VECTORS[]{
+  {"", 1, {0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4,
+           0xc8, 0x99, 0x6f, 0xb9, 0x24, 0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b,
+           0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55}},
+  {"abc", 1, {0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40,
+              0xde, 0x5d, 0xae, 0x22, 0x23, 0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17,
+              0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad}},
+  {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+   {0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26,
+    0x93, 0x0c, 0x3e, 0x60, 0x39, 0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff,
+    0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1}},
+  {"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+   "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+   10000,
+   {0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7,
+    0xe2, 0x84, 0xd7, 0x3e, 0x67, 0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97,
+    0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0}},
+};
+
+void
+verifySha256() {
+  bool ok = true;
+  for (const auto& v : SHA256_VECTORS) {
+    ndnph::port::Sha256 hash;
+    for (size_t i = 0; i < v.repeat; ++i) {
+      hash.update(reinterpret_cast<const uint8_t*>(v.input), strlen(v.input));
+    }
+    uint8_t digest[NDNPH_SHA256_LEN];
+    ok = hash.final(digest) && std::equal(digest, digest + sizeof(digest), v.digest) && ok;
+  }
+  printResult("SHA256 vectors", ok);
+}
+
+/** @brief RFC 4231 HMAC-SHA256 test vectors. */
+struct HmacVector {
+  uint8_t keyOctet;
+  size_t keyLen;
+  const char* input;
+  uint8_t mac[NDNPH_SHA256_LEN];
+};
+const HmacVector HMAC_VECTORS[]{
+  {0x0B, 20, "Hi There", {0xb0, 0x34, 0x4c, 0x61, 0xd8, 0xdb, 0x38, 0x53, 0x5c, 0xa8, 0xaf,
+                          0xce, 0xaf, 0x0b, 0xf1, 0x2b, 0x88, 0x1d, 0xc2, 0x00, 0xc9, 0x83,
+                          0x3d, 0xa7, 0x26, 0xe9, 0x37, 0x6c, 0x2e, 0x32, 0xcf, 0xf7}},
+  {0xAA, 131, "Test Using Larger Than Block-Size Key - Hash Key First",
+   {0x60, 0xe4, 0x31, 0x59, 0x1e, 0xe0, 0xb6, 0x7f, 0x0d, 0x8a, 0x26,
+    0xaa, 0xcb, 0xf5, 0xb7, 0x7f, 0x8e, 0x0b, 0xc6, 0x21, 0x37, 0x28,
+    0xc5, 0x14, 0x05, 0x46, 0x04, 0x0f, 0x0e, 0xe3, 0x7f, 0x54}},
+};
+
+void
+verifyHmac() {
+  bool ok = true;
+  for (const auto& v : HMAC_VECTORS) {
+    uint8_t key[131];
+    std::fill_n(key, v.keyLen, v.keyOctet);
+    ndnph::port::HmacSha256 hmac(key, v.keyLen);
+    // compute twice, to check that final() resets to the keyed state
+    for (int i = 0; i < 2; ++i) {
+      hmac.update(reinterpret_cast<const uint8_t*>(v.input), strlen(v.input));
+      uint8_t mac[NDNPH_SHA256_LEN];
+      ok = hmac.final(mac) && std::equal(mac, mac + sizeof(mac), v.mac) && ok;
+    }
+  }
+  printResult("HMAC vectors", ok);
+}
+
+uint8_t input[4096];
+
+void
+benchSha256() {
+  uint8_t digest[NDNPH_SHA256_LEN];
+  measure("SHA256 4096 octets, 1-octet updates", 4, sizeof(input), [&] {
+    ndnph::port::Sha256 hash;
+    for (uint8_t b : input) {
+      hash.update(&b, 1);
+    }
+    hash.final(digest);
+  });
+  for (size_t len : {64, 1024, 4096}) {
+    Serial.print(F("SHA256 "));
+    Serial.print(len);
+    measure(" octets", 64, len, [&] {
+      ndnph::port::Sha256 hash;
+      hash.update(input, len);
+      hash.final(digest);
+    });
+  }
+}
+
+void
+benchHmac() {
+  uint8_t key[32];
+  std::fill_n(key, sizeof(key), 0xA0);
+  uint8_t mac[NDNPH_SHA256_LEN];
+  for (size_t len : {64, 256}) {
+    Serial.print(F("HMAC "));
+    Serial.print(len);
+    measure(" octets, new key", 256, len, [&] {
+      ndnph::port::HmacSha256 hmac(key, sizeof(key));
+      hmac.update(input, len);
+      hmac.final(mac);
+    });
+
+    ndnph::port::HmacSha256 hmac(key, sizeof(key));
+    Serial.print(F("HMAC "));
+    Serial.print(len);
+    measure(" octets, same key", 256, len, [&] {
+      hmac.update(input, len);
+      hmac.final(mac);
+    });
+  }
+}
+
+/** @brief Generate random octets one at a time, as RandomSource did on ESP8266 and RP2040. */
+void
+randomPerOctet(uint8_t* output, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+#if defined(ARDUINO_ARCH_ESP8266)
+    output[i] = ::secureRandom(0x100);
+#elif defined(ARDUINO_ARCH_RP2040)
+    output[i] = rp2040.hwrand32();
+#else
+    ndnph::port::RandomSource::generateHardware(&output[i], 1);
+#endif
+  }
+}
+
+void
+benchRandom() {
+  static uint8_t output[1024];
+  for (size_t len : {32, 1024}) {
+    Serial.print(F("random "));
+    Serial.print(len);
+    measure(" octets, per-octet hardware", 16, len, [&] { randomPerOctet(output, len); });
+    Serial.print(F("random "));
+    Serial.print(len);
+    measure(" octets, bulk hardware", 16, len,
+            [&] { ndnph::port::RandomSource::generateHardware(output, len); });
+    Serial.print(F("random "));
+    Serial.print(len);
+    measure(" octets, RandomSource", 16, len,
+            [&] { ndnph::port::RandomSource::generate(output, len); });
+  }
+}
+
+#ifdef ESP8266NDN_PORT_EC_UECC
+const int ECDSA_POOL_DEPTH = 8;
+const int ECDSA_N_VERIFY = 8;
+
+/**
+ * @brief Compare ECDSA signing with an empty nonce pool against a full nonce pool,
+ *        verification with a generic key, a pinned key, and the result cache, and key import
+ *        with and without the validation cache.
+ */
+void
+benchEcdsa() {
+  using Ec = ndnph::port::Ec;
+  uint8_t pvtBits[Ec::Curve::PvtLen::value];
+  uint8_t pubBits[Ec::Curve::PubLen::value];
+  Ec::PrivateKey pvt;
+  Ec::PublicKey pub;
+  if (!Ec::generateKey(pvtBits, pubBits) || !pvt.import(pvtBits) || !pub.import(pubBits)) {
+    printResult("ECDSA key generation", false);
+    return;
+  }
+  yield();
+
+  uint8_t sig[Ec::Curve::MaxSigLen::value];
+  ssize_t sigLen = -1;
+  esp8266ndn::EcNoncePool::resize(0);
+  measure("ECDSA sign, cold", ECDSA_POOL_DEPTH, 0, [&] { sigLen = pvt.sign(input, sig); });
+  printResult("ECDSA cold signature", sigLen > 0 && pub.verify(input, sig, sigLen));
+
+  esp8266ndn::EcNoncePool::resize(ECDSA_POOL_DEPTH);
+  measure("ECDSA pool refill", ECDSA_POOL_DEPTH, 0, [] { esp8266ndn::EcNoncePool::refill(); });
+  measure("ECDSA sign, warm", ECDSA_POOL_DEPTH, 0, [&] { sigLen = pvt.sign(input, sig); });
+  printResult("ECDSA warm signature", sigLen > 0 && pub.verify(input, sig, sigLen));
+  esp8266ndn::EcNoncePool::resize(0);
+
+  bool ok = true;
+  auto verifyUncached = [&] {
+    esp8266ndn::EcVerifyCache::clear();
+    ok = pub.verify(input, sig, sigLen) && ok;
+  };
+  measure("ECDSA verify, generic", ECDSA_N_VERIFY, 0, verifyUncached);
+  for (int teeth : {4, 6}) {
+    Serial.print(F("ECDSA pin, teeth="));
+    Serial.print(teeth);
+    measure("", 1, 0, [&] { ok = esp8266ndn::EcPinnedKeys::pin(pubBits, teeth) && ok; });
+    Serial.print(F("ECDSA verify, teeth="));
+    Serial.print(teeth);
+    measure("", ECDSA_N_VERIFY, 0, verifyUncached);
+  }
+  esp8266ndn::EcPinnedKeys::clear();
+  measure("ECDSA verify, cached", ECDSA_N_VERIFY, 0,
+          [&] { ok = pub.verify(input, sig, sigLen) && ok; });
+  printResult("ECDSA verify", ok);
+
+  measure("ECDSA import, uncached", ECDSA_N_VERIFY, 0, [&] {
+    esp8266ndn::EcValidKeyCache::clear();
+    ok = pub.import(pubBits) && ok;
+  });
+  measure("ECDSA import, cached", ECDSA_N_VERIFY, 0, [&] { ok = pub.import(pubBits) && ok; });
+  printResult("ECDSA import", ok);
+}
+#endif // ESP8266NDN_PORT_EC_UECC
+
+void
+setup() {
+  Serial.begin(115200);
+  Serial.println();
+  esp8266ndn::setLogOutput(Serial);
+
+  for (size_t i = 0; i < sizeof(input); ++i) {
+    input[i] = static_cast<uint8_t>(i);
+  }
+  verifySha256();
+  verifyHmac();
+}
+
+void
+loop() {
+  benchSha256();
+  benchHmac();
+  benchRandom();
+#ifdef ESP8266NDN_PORT_EC_UECC
+  benchEcdsa();
+#endif
+  Serial.println();
+  delay(10000);
+}
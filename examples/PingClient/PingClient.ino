@@ -27,6 +27,7 @@ ndnph::StaticRegion<1024> region;
 ndnph::PingClient client0(ndnph::Name::parse(region, PREFIX0), face);
 ndnph::PingClient client1(ndnph::Name::parse(region, PREFIX1), face);
 ndnph::PingClient client2(ndnph::Name::parse(region, PREFIX2), face);
+esp8266ndn::PmtuDiscovery pmtud(face, transport, ndnph::Name::parse(region, PREFIX0));
 
 void
 setup() {
@@ -60,6 +61,7 @@ setup() {
     CHIP.restart();
   }
   transport.beginTunnel(fchResponse.ip);
+  pmtud.begin();
 }
 
 void
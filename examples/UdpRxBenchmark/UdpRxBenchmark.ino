@@ -0,0 +1,97 @@
+// See esp8266ndn/extras/UdpBench for a traffic generator that can drive this benchmark.
+
+#if defined(ARDUINO_ARCH_ESP8266)
+#include <ESP8266WiFi.h>
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#endif
+#include <esp8266ndn.h>
+
+const char* WIFI_SSID = "my-ssid";
+const char* WIFI_PASS = "my-pass";
+
+const int INTERVAL = 10000;
+
+esp8266ndn::UdpTransport transport;
+ndnph::Face face(transport);
+
+/** @brief Count received Interests without responding. */
+class RxCounter : public ndnph::PacketHandler {
+public:
+  using PacketHandler::PacketHandler;
+
+  uint32_t nInterests = 0;
+
+private:
+  bool processInterest(ndnph::Interest) final {
+    ++nInterests;
+    return true;
+  }
+};
+RxCounter counter(face);
+
+esp8266ndn::UdpTransport::Backend backend = esp8266ndn::UdpTransport::Backend::NetworkUdp;
+unsigned long lastReport = 0;
+
+const char*
+backendName() {
+  switch (backend) {
+    case esp8266ndn::UdpTransport::Backend::NetworkUdp:
+      return "NetworkUdp";
+    case esp8266ndn::UdpTransport::Backend::LwipPcb:
+      return "LwipPcb";
+  }
+  return "";
+}
+
+void
+startBackend() {
+  transport.end();
+  if (!transport.setBackend(backend) || !transport.beginListen()) {
+    Serial.print(backendName());
+    Serial.println(F(" initialization failed"));
+  }
+  counter.nInterests = 0;
+  lastReport = millis();
+}
+
+void
+setup() {
+  Serial.begin(115200);
+  Serial.println();
+  esp8266ndn::setLogOutput(Serial);
+
+  WiFi.persistent(false);
+  WiFi.mode(WIFI_STA);
+  WiFi.setSleep(false);
+  WiFi.begin(WIFI_SSID, WIFI_PASS);
+  if (WiFi.waitForConnectResult() != WL_CONNECTED) {
+    Serial.println(F("WiFi connect failed"));
+    ESP.restart();
+  }
+  delay(1000);
+
+  Serial.print(F("python udp-flood.py --host "));
+  Serial.println(WiFi.localIP());
+  startBackend();
+}
+
+void
+loop() {
+  face.loop();
+
+  unsigned long now = millis();
+  if (now - lastReport < INTERVAL) {
+    return;
+  }
+
+  Serial.print(backendName());
+  Serial.print(' ');
+  Serial.print(1000.0 * counter.nInterests / (now - lastReport));
+  Serial.println(F(" pps"));
+
+  backend = backend == esp8266ndn::UdpTransport::Backend::NetworkUdp
+              ? esp8266ndn::UdpTransport::Backend::LwipPcb
+              : esp8266ndn::UdpTransport::Backend::NetworkUdp;
+  startBackend();
+}
@@ -85,6 +85,188 @@ test(Ecdsa) {
   assertTrue(data.verify(pub0));
 }
 
+#ifdef ESP8266NDN_PORT_EC_UECC
+using Ec = ndnph::port::Ec;
+
+// micro-ecc key pair shared by Ec* tests
+struct EcKeyPair {
+  bool generate() {
+    return Ec::generateKey(pvtBits, pubBits) && pvt.import(pvtBits) && pub.import(pubBits);
+  }
+
+  uint8_t pvtBits[Ec::Curve::PvtLen::value];
+  uint8_t pubBits[Ec::Curve::PubLen::value];
+  Ec::PrivateKey pvt;
+  Ec::PublicKey pub;
+};
+
+// ECDSA signing with precomputed nonces
+test(EcNoncePool) {
+  EcKeyPair key;
+  assertTrue(key.generate());
+
+  assertTrue(esp8266ndn::EcNoncePool::resize(2));
+  assertTrue(esp8266ndn::EcNoncePool::refill());
+  assertTrue(esp8266ndn::EcNoncePool::refill());
+  assertFalse(esp8266ndn::EcNoncePool::refill());
+  assertEqual(esp8266ndn::EcNoncePool::size(), 2);
+
+  auto cnt0 = esp8266ndn::EcNoncePool::readCounters();
+  uint8_t digest[NDNPH_SHA256_LEN] = {0xD1};
+  uint8_t sig[Ec::Curve::MaxSigLen::value];
+  for (int i = 0; i < 3; ++i) {
+    digest[1] = i;
+    ssize_t sigLen = key.pvt.sign(digest, sig);
+    assertMore(sigLen, 0);
+    assertTrue(key.pub.verify(digest, sig, sigLen));
+  }
+  assertEqual(esp8266ndn::EcNoncePool::size(), 0);
+  auto cnt1 = esp8266ndn::EcNoncePool::readCounters();
+  assertEqual(cnt1.nHits - cnt0.nHits, 2);
+  assertEqual(cnt1.nMisses - cnt0.nMisses, 1);
+  assertTrue(esp8266ndn::EcNoncePool::resize(0));
+}
+
+// ECDSA verification with comb tables
+test(EcPinnedKeys) {
+  EcKeyPair key;
+  assertTrue(key.generate());
+
+  uint8_t digest[NDNPH_SHA256_LEN] = {0xD2};
+  uint8_t sig[Ec::Curve::MaxSigLen::value];
+  ssize_t sigLen = key.pvt.sign(digest, sig);
+  assertMore(sigLen, 0);
+
+  assertTrue(esp8266ndn::EcPinnedKeys::pin(key.pubBits));
+  assertEqual(esp8266ndn::EcPinnedKeys::size(), 1);
+  auto cnt0 = esp8266ndn::EcPinnedKeys::readCounters();
+  assertTrue(key.pub.verify(digest, sig, sigLen));
+  digest[1] = 0x01;
+  assertFalse(key.pub.verify(digest, sig, sigLen));
+  auto cnt1 = esp8266ndn::EcPinnedKeys::readCounters();
+  assertEqual(cnt1.nHits - cnt0.nHits, 2);
+
+  assertTrue(esp8266ndn::EcPinnedKeys::unpin(key.pubBits));
+  assertFalse(esp8266ndn::EcPinnedKeys::unpin(key.pubBits));
+  assertEqual(esp8266ndn::EcPinnedKeys::size(), 0);
+  digest[1] = 0x00;
+  esp8266ndn::EcVerifyCache::clear();
+  assertTrue(key.pub.verify(digest, sig, sigLen));
+  auto cnt2 = esp8266ndn::EcPinnedKeys::readCounters();
+  assertEqual(cnt2.nMisses - cnt1.nMisses, 1);
+}
+
+// ECDSA verification result cache
+test(EcVerifyCache) {
+  EcKeyPair key;
+  assertTrue(key.generate());
+
+  uint8_t digest[NDNPH_SHA256_LEN] = {0xD3};
+  uint8_t sig[Ec::Curve::MaxSigLen::value];
+  ssize_t sigLen = key.pvt.sign(digest, sig);
+  assertMore(sigLen, 0);
+  esp8266ndn::EcVerifyCache::clear();
+
+  auto cnt0 = esp8266ndn::EcVerifyCache::readCounters();
+  assertTrue(key.pub.verify(digest, sig, sigLen));
+  assertTrue(key.pub.verify(digest, sig, sigLen));
+  auto cnt1 = esp8266ndn::EcVerifyCache::readCounters();
+  assertEqual(cnt1.nMisses - cnt0.nMisses, 1);
+  assertEqual(cnt1.nHits - cnt0.nHits, 1);
+
+  // failed verification is not cached
+  digest[1] = 0x01;
+  assertFalse(key.pub.verify(digest, sig, sigLen));
+  assertFalse(key.pub.verify(digest, sig, sigLen));
+  auto cnt2 = esp8266ndn::EcVerifyCache::readCounters();
+  assertEqual(cnt2.nMisses - cnt1.nMisses, 2);
+  assertEqual(cnt2.nHits, cnt1.nHits);
+
+  // cached verification does not apply to another key
+  EcKeyPair key2;
+  assertTrue(key2.generate());
+  digest[1] = 0x00;
+  assertFalse(key2.pub.verify(digest, sig, sigLen));
+}
+
+// public key validation cache
+test(EcValidKeyCache) {
+  EcKeyPair key;
+  assertTrue(key.generate());
+  uint8_t* pubBits = key.pubBits;
+  esp8266ndn::EcValidKeyCache::clear();
+
+  auto cnt0 = esp8266ndn::EcValidKeyCache::readCounters();
+  for (int i = 0; i < 3; ++i) {
+    Ec::PublicKey pub;
+    assertTrue(pub.import(pubBits));
+  }
+  auto cnt1 = esp8266ndn::EcValidKeyCache::readCounters();
+  assertEqual(cnt1.nMisses - cnt0.nMisses, 1);
+  assertEqual(cnt1.nHits - cnt0.nHits, 2);
+
+  pubBits[Ec::Curve::PubLen::value - 1] ^= 0x01;
+  for (int i = 0; i < 2; ++i) {
+    Ec::PublicKey pub;
+    assertFalse(pub.import(pubBits));
+  }
+  auto cnt2 = esp8266ndn::EcValidKeyCache::readCounters();
+  assertEqual(cnt2.nMisses - cnt1.nMisses, 2);
+  assertEqual(cnt2.nHits, cnt1.nHits);
+}
+#endif
+
+#ifdef ESP8266NDN_HAVE_CRYPTO_WORKER
+// ECDSA signing and verification on a worker task
+test(CryptoWorker) {
+  region.reset();
+  ndnph::EcPrivateKey pvt;
+  ndnph::EcPublicKey pub;
+  assertTrue(ndnph::ec::generate(region, ndnph::Name::parse(region, "/K"), pvt, pub));
+
+  struct Job {
+    std::array<uint8_t, 64> input;
+    std::array<uint8_t, ndnph::port::Ec::Curve::MaxSigLen::value> sig;
+    ssize_t sigLen = 0;
+    int verified = -1;
+  };
+  std::array<Job, 3> jobs;
+  esp8266ndn::CryptoWorker worker;
+  auto signCb = [](void* ctx, ssize_t sigLen) { static_cast<Job*>(ctx)->sigLen = sigLen; };
+  auto verifyCb = [](void* ctx, bool ok) { static_cast<Job*>(ctx)->verified = ok; };
+  auto waitPending = [&] {
+    for (int i = 0; i < 10000 && worker.pending() > 0; ++i) {
+      worker.loop();
+      delay(1);
+    }
+  };
+
+  assertFalse(worker.sign(pvt, jobs[0].input.data(), jobs[0].input.size(), jobs[0].sig.data(),
+                          signCb, &jobs[0]));
+  assertTrue(worker.begin());
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    auto& job = jobs[i];
+    job.input.fill(static_cast<uint8_t>(i));
+    assertTrue(worker.sign(pvt, job.input.data(), job.input.size(), job.sig.data(), signCb, &job));
+  }
+  assertEqual(worker.pending(), jobs.size());
+  waitPending();
+  assertEqual(worker.pending(), 0);
+
+  jobs[2].sig[8] ^= 0x01;
+  for (auto& job : jobs) {
+    assertMore(job.sigLen, 0);
+    assertTrue(worker.verify(pub, job.input.data(), job.input.size(), job.sig.data(), job.sigLen,
+                             verifyCb, &job));
+  }
+  waitPending();
+  assertEqual(jobs[0].verified, 1);
+  assertEqual(jobs[1].verified, 1);
+  assertEqual(jobs[2].verified, 0);
+  worker.end();
+}
+#endif
+
 // HMAC-SHA256
 test(Hmac) {
   // https://datatracker.ietf.org/doc/html/rfc4231#section-4.4
@@ -120,6 +302,216 @@ test(Hmac) {
                sig.data(), sig.size()));
 }
 
+// UDP remote endpoint table with LRU eviction
+test(UdpEndpointTable) {
+  esp8266ndn::UdpEndpointTable table(2);
+  const uint8_t addrA[16]{0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x0A};
+  const uint8_t addrB[16]{0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x0B};
+  const uint8_t addrC[16]{0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x0C};
+  const uint8_t addr4[4]{192, 0, 2, 1};
+
+  uint64_t idA = table.encode(addrA, sizeof(addrA), 6363);
+  uint64_t idB = table.encode(addrB, sizeof(addrB), 6363);
+  assertNotEqual(idA, 0);
+  assertNotEqual(idB, 0);
+  assertNotEqual(idA, idB);
+  assertEqual(table.encode(addrA, sizeof(addrA), 6363), idA);
+  assertNotEqual(table.encode(addrA, sizeof(addrA), 56363), idA);
+
+  uint64_t idC = table.encode(addrC, sizeof(addrC), 6363);
+  uint8_t addr[16];
+  uint16_t port = 0;
+  assertEqual(table.decode(idA, addr, &port), 0);
+  assertEqual(table.decode(idB, addr, &port), 0);
+  assertEqual(table.decode(idC, addr, &port), 16);
+  assertEqual(port, 6363);
+  assertEqual(addr[15], 0x0C);
+  assertEqual(table.decode(0, addr, &port), 0);
+
+  // IPv4 endpoints are encoded directly, without evicting IPv6 endpoints
+  for (uint16_t p = 1; p <= 20; ++p) {
+    uint64_t id4 = table.encode(addr4, sizeof(addr4), p);
+    assertNotEqual(id4, 0);
+    assertEqual(table.decode(id4, addr, &port), 4);
+    assertEqual(port, p);
+    assertEqual(addr[3], 1);
+  }
+  assertEqual(table.decode(idC, addr, &port), 16);
+
+  auto cnt = table.readCounters();
+  assertEqual(cnt.nInserts, 4);
+  assertEqual(cnt.nReuses, 1);
+  assertEqual(cnt.nEvictions, 2);
+}
+
+// UDP TX queue with token bucket pacing
+test(UdpTxQueue) {
+  esp8266ndn::UdpTxQueue queue;
+  assertTrue(queue.resize(2, 8));
+  const uint8_t pkt[9]{0x05, 0x01, 0xA0};
+
+  assertEqual(queue.front(), nullptr);
+  assertTrue(queue.push(pkt, 3, 1001));
+  assertTrue(queue.push(pkt, 8, 1002));
+  assertFalse(queue.push(pkt, 1, 1003));
+  assertEqual(queue.size(), 2);
+
+  auto item = queue.front();
+  assertNotEqual(item, nullptr);
+  assertEqual(item->pktLen, 3);
+  assertEqual(item->pkt[2], 0xA0);
+  assertEqual(item->endpointId, 1001);
+  queue.pop();
+  assertFalse(queue.push(pkt, 9, 1004));
+  assertTrue(queue.push(pkt, 2, 1005));
+  assertEqual(queue.front()->endpointId, 1002);
+  queue.pop();
+  assertEqual(queue.front()->endpointId, 1005);
+  queue.pop();
+  assertEqual(queue.size(), 0);
+
+  using Clock = ndnph::port::Clock;
+  auto t0 = Clock::now();
+  assertTrue(queue.take(t0));
+  queue.setRate(100, 2); // one token per 10ms
+  assertTrue(queue.take(t0));
+  assertTrue(queue.take(t0));
+  assertFalse(queue.take(t0));
+  assertFalse(queue.take(Clock::add(t0, 9)));
+  assertTrue(queue.take(Clock::add(t0, 10)));
+  assertFalse(queue.take(Clock::add(t0, 10)));
+  assertTrue(queue.take(Clock::add(t0, 4000)));
+  assertTrue(queue.take(Clock::add(t0, 4000)));
+  assertFalse(queue.take(Clock::add(t0, 4000)));
+}
+
+// NDNLPv2 fragmentation with per-link MTU and reassembly
+test(LpFragmentation) {
+  esp8266ndn::LpFragmenter fragmenter(100);
+  esp8266ndn::LpReassembler reassembler(2, 1500);
+  static uint8_t pkt[600];
+  pkt[0] = 0x06;
+  pkt[1] = 0xFD;
+  pkt[2] = 0x02;
+  pkt[3] = 0x54;
+  for (size_t i = 4; i < sizeof(pkt); ++i) {
+    pkt[i] = i;
+  }
+
+  const uint8_t* frame = nullptr;
+  const uint8_t* output = nullptr;
+  size_t outputLen = 0;
+  assertEqual(fragmenter.begin(pkt, 80, 100), 1);
+  assertEqual(fragmenter.next(frame), 80);
+  assertTrue(frame == pkt);
+  assertEqual(fragmenter.next(frame), 0);
+  assertTrue(reassembler.process(1, pkt, 80, output, outputLen) ==
+             esp8266ndn::LpReassembler::Result::Pass);
+
+  size_t nFrames = fragmenter.begin(pkt, sizeof(pkt), 100);
+  assertEqual(nFrames, 9);
+  for (size_t i = 0; i < nFrames; ++i) {
+    size_t frameLen = fragmenter.next(frame);
+    assertLessOrEqual(frameLen, 100);
+    auto res = reassembler.process(1, frame, frameLen, output, outputLen);
+    if (i + 1 < nFrames) {
+      assertTrue(res == esp8266ndn::LpReassembler::Result::Accepted);
+    } else {
+      assertTrue(res == esp8266ndn::LpReassembler::Result::Complete);
+    }
+  }
+  assertEqual(fragmenter.next(frame), 0);
+  assertEqual(outputLen, sizeof(pkt));
+  assertEqual(std::memcmp(output, pkt, sizeof(pkt)), 0);
+
+  fragmenter.begin(pkt, sizeof(pkt), 60);
+  size_t frameLen = fragmenter.next(frame);
+  assertTrue(reassembler.process(2, frame, frameLen, output, outputLen) ==
+             esp8266ndn::LpReassembler::Result::Accepted);
+  fragmenter.next(frame);
+  frameLen = fragmenter.next(frame); // skip one fragment
+  assertTrue(reassembler.process(2, frame, frameLen, output, outputLen) ==
+             esp8266ndn::LpReassembler::Result::Dropped);
+
+  // a new link takes the idle slot of link 2, not the slot of link 1 that is mid-reassembly
+  nFrames = fragmenter.begin(pkt, sizeof(pkt), 100);
+  frameLen = fragmenter.next(frame);
+  assertTrue(reassembler.process(1, frame, frameLen, output, outputLen) ==
+             esp8266ndn::LpReassembler::Result::Accepted);
+  assertTrue(reassembler.process(3, frame, frameLen, output, outputLen) ==
+             esp8266ndn::LpReassembler::Result::Accepted);
+  outputLen = 0;
+  for (size_t i = 1; i < nFrames; ++i) {
+    frameLen = fragmenter.next(frame);
+    reassembler.process(1, frame, frameLen, output, outputLen);
+  }
+  assertEqual(outputLen, sizeof(pkt));
+
+  auto cnt = reassembler.readCounters();
+  assertEqual(cnt.nDelivered, 2);
+  assertEqual(cnt.nDropped, 2);
+}
+
+// Bloom filter of Interest name prefixes
+test(PrefixFilter) {
+  region.reset();
+  esp8266ndn::PrefixFilter filter;
+  const uint8_t interestAB[]{0x05, 0x08, 0x07, 0x06, 0x08, 0x01, 0x41, 0x08, 0x01, 0x42};
+  const uint8_t interestC[]{0x05, 0x05, 0x07, 0x03, 0x08, 0x01, 0x43};
+  const uint8_t dataC[]{0x06, 0x05, 0x07, 0x03, 0x08, 0x01, 0x43};
+  const uint8_t lpInterestC[]{0x64, 0x09, 0x50, 0x07, 0x05, 0x05, 0x07, 0x03, 0x08, 0x01, 0x43};
+
+  assertFalse(filter.accept(interestAB, sizeof(interestAB)));
+  assertTrue(filter.accept(dataC, sizeof(dataC)));
+
+  assertTrue(filter.addPrefix(ndnph::Name::parse(region, "/A")));
+  assertTrue(filter.accept(interestAB, sizeof(interestAB)));
+  assertTrue(filter.accept(interestAB, 8)); // name truncated within second component
+  assertFalse(filter.accept(interestC, sizeof(interestC)));
+  assertFalse(filter.accept(lpInterestC, sizeof(lpInterestC)));
+  assertTrue(filter.accept(dataC, sizeof(dataC)));
+
+  filter.clear();
+  assertFalse(filter.accept(interestAB, sizeof(interestAB)));
+  assertTrue(filter.addPrefix(ndnph::Name()));
+  assertTrue(filter.accept(interestC, sizeof(interestC)));
+}
+
+// ChaCha20 random bytes generator with fast key erasure
+int nChaChaSeeds = 0;
+
+bool
+zeroChaChaSeed(uint8_t* output, size_t count) {
+  ++nChaChaSeeds;
+  std::fill_n(output, count, 0);
+  return true;
+}
+
+test(ChaChaDrbg) {
+  esp8266ndn::ChaChaDrbg drbg(zeroChaChaSeed);
+  std::array<uint8_t, 40> output;
+  assertTrue(drbg.generate(output.data(), 5));
+  assertTrue(drbg.generate(&output[5], 35));
+  assertEqual(nChaChaSeeds, 1);
+
+  // https://datatracker.ietf.org/doc/html/rfc8439#appendix-A.1 test vectors #1 and #2:
+  // octets 32-63 of block 0, then octets 0-7 of block 1
+  std::array<uint8_t, 40> expected{
+    0xDA, 0x41, 0x59, 0x7C, 0x51, 0x57, 0x48, 0x8D, 0x77, 0x24, 0xE0, 0x3F, 0xB8, 0xD8,
+    0x4A, 0x37, 0x6A, 0x43, 0xB8, 0xF4, 0x15, 0x18, 0xA1, 0x1C, 0xC3, 0x87, 0xB6, 0x69,
+    0xB2, 0xEE, 0x65, 0x86, 0x9F, 0x07, 0xE7, 0xBE, 0x55, 0x51, 0x38, 0x7A};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    assertEqual(output[i], expected[i], i);
+  }
+
+  std::array<uint8_t, 1024> big;
+  assertTrue(drbg.generate(big.data(), big.size()));
+  assertEqual(nChaChaSeeds, 1);
+  drbg.reseed();
+  assertTrue(drbg.generate(output.data(), 1));
+  assertEqual(nChaChaSeeds, 2);
+}
+
 void
 setup() {
 #if ARDUINO_USB_CDC_ON_BOOT
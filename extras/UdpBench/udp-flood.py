@@ -0,0 +1,43 @@
+import argparse
+import socket
+import struct
+import time
+
+parser = argparse.ArgumentParser(
+    description='Send a flood of NDN Interests over UDP.')
+parser.add_argument('--host', type=str, required=True, help='target address')
+parser.add_argument('--port', type=int, default=6363, help='target port')
+parser.add_argument('--prefix', type=str, default='bench', help='name component')
+parser.add_argument('--duration', type=float, default=0, help='duration (s), 0 for unlimited')
+args = parser.parse_args()
+
+
+def tlv(typ, value):
+    assert typ < 0xFD
+    if len(value) < 0xFD:
+        return bytes([typ, len(value)]) + value
+    return bytes([typ, 0xFD]) + struct.pack('!H', len(value)) + value
+
+
+def make_interest(seq):
+    comps = tlv(0x08, args.prefix.encode()) + tlv(0x08, struct.pack('!Q', seq))
+    fields = tlv(0x07, comps) + tlv(0x0A, struct.pack('!I', seq & 0xFFFFFFFF))
+    return tlv(0x05, fields)
+
+
+sock = socket.socket(socket.getaddrinfo(args.host, args.port)[0][0], socket.SOCK_DGRAM)
+sock.connect((args.host, args.port))
+
+t0 = time.monotonic()
+lastReport, nLastReport = t0, 0
+seq = 0
+while args.duration == 0 or time.monotonic() - t0 < args.duration:
+    try:
+        sock.send(make_interest(seq))
+    except BlockingIOError:
+        continue
+    seq += 1
+    now = time.monotonic()
+    if now - lastReport >= 1:
+        print('%d sent %0.1f pps' % (seq, (seq - nLastReport) / (now - lastReport)))
+        lastReport, nLastReport = now, seq
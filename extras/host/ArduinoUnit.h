@@ -0,0 +1,74 @@
+#ifndef ESP8266NDN_EXTRAS_HOST_ARDUINOUNIT_H
+#define ESP8266NDN_EXTRAS_HOST_ARDUINOUNIT_H
+
+/**
+ * @file
+ * Subset of ArduinoUnit API for running examples/unittest on Linux.
+ *
+ * Each test runs once. A failed assertion prints its location and returns from the test.
+ */
+
+#include <Arduino.h>
+
+/** @brief Serial console on stdout. */
+class HostSerial : public FilePrint {
+public:
+  HostSerial()
+    : FilePrint(stdout) {}
+
+  void begin(unsigned long) {}
+
+  explicit operator bool() const {
+    return true;
+  }
+};
+
+extern HostSerial Serial;
+
+class Test {
+public:
+  explicit Test(const char* name);
+
+  /** @brief Run every registered test. */
+  static void run();
+
+  /** @brief Return number of failed tests. */
+  static int nFailed();
+
+  /** @brief Record assertion failure in the current test. */
+  static void fail(const char* file, int line, const char* expr);
+
+protected:
+  virtual void once() = 0;
+
+private:
+  const char* m_name;
+  Test* m_next;
+};
+
+#define test(name)                                                                                 \
+  struct test_##name : public ::Test {                                                             \
+    test_##name()                                                                                  \
+      : Test(#name) {}                                                                             \
+    void once() override;                                                                          \
+  } test_##name##_instance;                                                                        \
+  void test_##name::once()
+
+#define ARDUINOUNIT_HOST_ASSERT(cond, expr)                                                        \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      ::Test::fail(__FILE__, __LINE__, expr);                                                      \
+      return;                                                                                      \
+    }                                                                                              \
+  } while (false)
+
+#define assertTrue(x, ...) ARDUINOUNIT_HOST_ASSERT((x), #x)
+#define assertFalse(x, ...) ARDUINOUNIT_HOST_ASSERT(!(x), "!(" #x ")")
+#define assertEqual(a, b, ...) ARDUINOUNIT_HOST_ASSERT((a) == (b), #a " == " #b)
+#define assertNotEqual(a, b, ...) ARDUINOUNIT_HOST_ASSERT((a) != (b), #a " != " #b)
+#define assertLess(a, b, ...) ARDUINOUNIT_HOST_ASSERT((a) < (b), #a " < " #b)
+#define assertMore(a, b, ...) ARDUINOUNIT_HOST_ASSERT((a) > (b), #a " > " #b)
+#define assertLessOrEqual(a, b, ...) ARDUINOUNIT_HOST_ASSERT((a) <= (b), #a " <= " #b)
+#define assertMoreOrEqual(a, b, ...) ARDUINOUNIT_HOST_ASSERT((a) >= (b), #a " >= " #b)
+
+#endif // ESP8266NDN_EXTRAS_HOST_ARDUINOUNIT_H
@@ -0,0 +1,53 @@
+#include "transport/ble-tx-queue.hpp"
+
+#include "ArduinoUnit.h"
+
+// BLE notification queue with credit-based flow control, against a mock characteristic
+test(BleTxQueue) {
+  struct MockChr {
+    bool notify(uint16_t connHandle, const void* data, uint16_t len) {
+      lastConn = connHandle;
+      lastLen = len;
+      return ++nCalls != failAt;
+    }
+    int nCalls = 0;
+    int failAt = 0;
+    uint16_t lastConn = 0;
+    uint16_t lastLen = 0;
+  } chr;
+
+  esp8266ndn::BleTxQueue queue;
+  assertTrue(queue.resize(3, 8));
+  const uint8_t pkt[9]{0x05, 0x01, 0xA0};
+  assertTrue(queue.push(pkt, 3, 1));
+  assertTrue(queue.push(pkt, 4, 1));
+  assertTrue(queue.push(pkt, 5, 1));
+  assertFalse(queue.push(pkt, 6, 1));
+  assertFalse(queue.push(pkt, 9, 1));
+  assertEqual(queue.drain(chr), 0); // no credit before connection
+
+  queue.setCredits(2);
+  assertEqual(queue.drain(chr), 2);
+  assertEqual(chr.lastLen, 4);
+  assertEqual(queue.size(), 1);
+  assertEqual(queue.drain(chr), 0);
+
+  queue.complete(1);
+  assertTrue(queue.push(pkt, 6, 2));
+  assertEqual(queue.drain(chr), 1);
+  assertEqual(chr.lastLen, 5);
+  assertEqual(queue.size(), 1);
+
+  chr.failAt = 4;
+  queue.complete(2);
+  assertTrue(queue.push(pkt, 7, 2));
+  assertEqual(queue.drain(chr), 1); // failed notification returns its credit
+  assertEqual(chr.lastConn, 2);
+  assertEqual(chr.lastLen, 7);
+  assertEqual(queue.size(), 0);
+
+  auto cnt = queue.readCounters();
+  assertEqual(cnt.nSent, 4);
+  assertEqual(cnt.nFull, 1);
+  assertEqual(cnt.nErrors, 1);
+}
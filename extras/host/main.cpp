@@ -0,0 +1,57 @@
+#include "ArduinoUnit.h"
+
+#include <cstdio>
+
+void
+setup();
+
+void
+loop();
+
+HostSerial Serial;
+
+namespace {
+
+Test* tests = nullptr;
+Test** testsTail = &tests;
+bool currentFailed = false;
+int nPassed = 0;
+int nFailedTests = 0;
+
+} // anonymous namespace
+
+Test::Test(const char* name)
+  : m_name(name)
+  , m_next(nullptr) {
+  *testsTail = this;
+  testsTail = &m_next;
+}
+
+void
+Test::run() {
+  for (Test* t = tests; t != nullptr; t = t->m_next) {
+    currentFailed = false;
+    t->once();
+    std::printf("Test %s %s.\n", t->m_name, currentFailed ? "failed" : "passed");
+    ++(currentFailed ? nFailedTests : nPassed);
+  }
+  std::printf("Test summary: %d passed, %d failed.\n", nPassed, nFailedTests);
+}
+
+int
+Test::nFailed() {
+  return nFailedTests;
+}
+
+void
+Test::fail(const char* file, int line, const char* expr) {
+  currentFailed = true;
+  std::printf("Assertion failed: %s, file %s, line %d.\n", expr, file, line);
+}
+
+int
+main() {
+  setup();
+  loop();
+  return Test::nFailed() == 0 ? 0 : 1;
+}
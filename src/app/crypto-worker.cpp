@@ -0,0 +1,195 @@
+#include "crypto-worker.hpp"
+
+#ifdef ESP8266NDN_HAVE_CRYPTO_WORKER
+
+#include "../core/logger.hpp"
+
+#define LOG(...) LOGGER(CryptoWorker, __VA_ARGS__)
+
+namespace esp8266ndn {
+
+CryptoWorker::~CryptoWorker() {
+  end();
+}
+
+bool
+CryptoWorker::begin() {
+  if (m_running) {
+    return true;
+  }
+  m_stop = false;
+
+#ifdef ESP8266NDN_PORT_QUEUE_FREERTOS
+  m_taskExited = false;
+  BaseType_t core = 1 - xPortGetCoreID();
+  if (xTaskCreatePinnedToCore(taskMain, "CryptoWorker", StackSize, this, Priority, &m_task, core) !=
+      pdPASS) {
+    LOG(F("xTaskCreatePinnedToCore error"));
+    return false;
+  }
+  LOG(F("worker running on core ") << _DEC(core));
+#else
+  sem_init(&m_wake, 0, 0);
+  int e = pthread_create(&m_thread, nullptr, threadMain, this);
+  if (e != 0) {
+    LOG(F("pthread_create error ") << _DEC(e));
+    sem_destroy(&m_wake);
+    return false;
+  }
+#endif
+
+  m_running = true;
+  return true;
+}
+
+void
+CryptoWorker::end() {
+  if (!m_running) {
+    return;
+  }
+  m_stop = true;
+  wake();
+
+#ifdef ESP8266NDN_PORT_QUEUE_FREERTOS
+  while (!m_taskExited) {
+    vTaskDelay(1);
+  }
+  m_task = nullptr;
+#else
+  pthread_join(m_thread, nullptr);
+  sem_destroy(&m_wake);
+#endif
+  m_running = false;
+
+  loop();
+  while (true) {
+    Job job;
+    bool ok = false;
+    std::tie(job, ok) = m_jobs.pop();
+    if (!ok) {
+      break;
+    }
+    job.result = -1;
+    --m_nPending;
+    deliver(job);
+  }
+}
+
+bool
+CryptoWorker::sign(const ndnph::PrivateKey& key, const uint8_t* input, size_t inputLen,
+                   uint8_t* sig, SignCallback cb, void* ctx) {
+  Job job{};
+  job.pvt = &key;
+  job.input = input;
+  job.inputLen = inputLen;
+  job.sigOut = sig;
+  job.signCb = cb;
+  job.ctx = ctx;
+  return submit(job);
+}
+
+bool
+CryptoWorker::verify(const ndnph::PublicKey& key, const uint8_t* input, size_t inputLen,
+                     const uint8_t* sig, size_t sigLen, VerifyCallback cb, void* ctx) {
+  Job job{};
+  job.pub = &key;
+  job.input = input;
+  job.inputLen = inputLen;
+  job.sig = sig;
+  job.sigLen = sigLen;
+  job.verifyCb = cb;
+  job.ctx = ctx;
+  return submit(job);
+}
+
+bool
+CryptoWorker::submit(const Job& job) {
+  // results queue has the same capacity, so that the worker can always post a result
+  if (!m_running || m_nPending >= QueueCapacity || !m_jobs.push(job)) {
+    return false;
+  }
+  ++m_nPending;
+  wake();
+  return true;
+}
+
+void
+CryptoWorker::loop() {
+  while (true) {
+    Job job;
+    bool ok = false;
+    std::tie(job, ok) = m_results.pop();
+    if (!ok) {
+      break;
+    }
+    --m_nPending;
+    deliver(job);
+  }
+}
+
+void
+CryptoWorker::deliver(const Job& job) {
+  if (job.signCb != nullptr) {
+    job.signCb(job.ctx, job.result);
+  } else if (job.verifyCb != nullptr) {
+    job.verifyCb(job.ctx, job.result > 0);
+  }
+}
+
+void
+CryptoWorker::execute(Job& job) {
+  if (job.pvt != nullptr) {
+    job.result = job.pvt->sign({ndnph::tlv::Value(job.input, job.inputLen)}, job.sigOut);
+  } else {
+    job.result = job.pub->verify({ndnph::tlv::Value(job.input, job.inputLen)}, job.sig, job.sigLen);
+  }
+}
+
+void
+CryptoWorker::run() {
+  while (!m_stop) {
+    Job job;
+    bool ok = false;
+    std::tie(job, ok) = m_jobs.pop();
+    if (!ok) {
+#ifdef ESP8266NDN_PORT_QUEUE_FREERTOS
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#else
+      sem_wait(&m_wake);
+#endif
+      continue;
+    }
+
+    execute(job);
+    m_results.push(job);
+  }
+}
+
+void
+CryptoWorker::wake() {
+#ifdef ESP8266NDN_PORT_QUEUE_FREERTOS
+  xTaskNotifyGive(m_task);
+#else
+  sem_post(&m_wake);
+#endif
+}
+
+#ifdef ESP8266NDN_PORT_QUEUE_FREERTOS
+void
+CryptoWorker::taskMain(void* self) {
+  auto worker = static_cast<CryptoWorker*>(self);
+  worker->run();
+  worker->m_taskExited = true;
+  vTaskDelete(nullptr);
+}
+#else
+void*
+CryptoWorker::threadMain(void* self) {
+  static_cast<CryptoWorker*>(self)->run();
+  return nullptr;
+}
+#endif
+
+} // namespace esp8266ndn
+
+#endif // ESP8266NDN_HAVE_CRYPTO_WORKER
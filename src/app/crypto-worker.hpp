@@ -0,0 +1,167 @@
+#ifndef ESP8266NDN_APP_CRYPTO_WORKER_HPP
+#define ESP8266NDN_APP_CRYPTO_WORKER_HPP
+
+#include "../port/port.hpp"
+
+#if (defined(ARDUINO_ARCH_ESP32) && defined(ESP8266NDN_PORT_QUEUE_FREERTOS)) ||                    \
+  defined(ESP8266NDN_PORT_QUEUE_PTHREAD)
+#define ESP8266NDN_HAVE_CRYPTO_WORKER
+
+#include <atomic>
+
+#ifdef ESP8266NDN_PORT_QUEUE_FREERTOS
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <semaphore.h>
+#endif
+
+namespace esp8266ndn {
+
+/**
+ * @brief Asynchronous signing and verification on a worker task.
+ *
+ * On dual-core ESP32, the worker is a FreeRTOS task pinned to the core other than the caller of
+ * begin(). On Linux, the worker is a pthread. Jobs and results are passed through SafeQueue, and
+ * callbacks are invoked from loop(), so that they run on the same task as the Face. Meanwhile, the
+ * caller can continue processing packets.
+ *
+ * A key submitted to the worker must not be used on other tasks until its callback is invoked.
+ * With the micro-ecc port on Linux, EcNoncePool, EcPinnedKeys, and the key and verification caches
+ * are guarded by a mutex, so that the application can refill the nonce pool from loop().
+ */
+class CryptoWorker {
+public:
+  /**
+   * @brief Callback upon signing completion.
+   * @param ctx context pointer passed to sign().
+   * @param sigLen signature length, or -1 on failure.
+   */
+  using SignCallback = void (*)(void* ctx, ssize_t sigLen);
+
+  /**
+   * @brief Callback upon verification completion.
+   * @param ctx context pointer passed to verify().
+   * @param ok whether the signature is valid.
+   */
+  using VerifyCallback = void (*)(void* ctx, bool ok);
+
+  CryptoWorker() = default;
+
+  ~CryptoWorker();
+
+  CryptoWorker(const CryptoWorker&) = delete;
+  CryptoWorker& operator=(const CryptoWorker&) = delete;
+
+  /**
+   * @brief Start the worker.
+   * @return whether success.
+   */
+  bool begin();
+
+  /**
+   * @brief Stop the worker.
+   *
+   * This waits for the current job to complete. Completed jobs are delivered to their callbacks;
+   * jobs that have not started are delivered as failures.
+   */
+  void end();
+
+  /**
+   * @brief Submit a signing job.
+   * @param key private key.
+   * @param input signed portion.
+   * @param sig signature buffer, at least key.getMaxSigLen() octets.
+   * @param cb callback.
+   * @param ctx context pointer passed to callback.
+   * @return whether the job is accepted; false if the worker is stopped or the queue is full.
+   *
+   * @p key , @p input , and @p sig must remain valid until the callback is invoked.
+   */
+  bool sign(const ndnph::PrivateKey& key, const uint8_t* input, size_t inputLen, uint8_t* sig,
+            SignCallback cb, void* ctx = nullptr);
+
+  /**
+   * @brief Submit a verification job.
+   * @param key public key.
+   * @param input signed portion.
+   * @param sig signature.
+   * @param cb callback.
+   * @param ctx context pointer passed to callback.
+   * @return whether the job is accepted; false if the worker is stopped or the queue is full.
+   *
+   * @p key , @p input , and @p sig must remain valid until the callback is invoked.
+   */
+  bool verify(const ndnph::PublicKey& key, const uint8_t* input, size_t inputLen,
+              const uint8_t* sig, size_t sigLen, VerifyCallback cb, void* ctx = nullptr);
+
+  /**
+   * @brief Deliver completed jobs to their callbacks.
+   *
+   * This should be invoked in loop().
+   */
+  void loop();
+
+  /** @brief Return number of jobs whose callbacks have not been invoked. */
+  size_t pending() const {
+    return m_nPending;
+  }
+
+public:
+  enum {
+    QueueCapacity = 8,
+    /** @brief Worker stack size in octets, enough for mbedtls ECDSA. */
+    StackSize = 8192,
+    Priority = 1,
+  };
+
+private:
+  struct Job {
+    const ndnph::PrivateKey* pvt;
+    const ndnph::PublicKey* pub;
+    const uint8_t* input;
+    size_t inputLen;
+    uint8_t* sigOut;
+    const uint8_t* sig;
+    size_t sigLen;
+    SignCallback signCb;
+    VerifyCallback verifyCb;
+    void* ctx;
+    ssize_t result;
+  };
+
+  bool submit(const Job& job);
+
+  static void deliver(const Job& job);
+
+  static void execute(Job& job);
+
+  void run();
+
+  void wake();
+
+#ifdef ESP8266NDN_PORT_QUEUE_FREERTOS
+  static void taskMain(void* self);
+#else
+  static void* threadMain(void* self);
+#endif
+
+private:
+  ndnph::port::SafeQueue<Job, QueueCapacity> m_jobs;
+  ndnph::port::SafeQueue<Job, QueueCapacity> m_results;
+  size_t m_nPending = 0;
+  bool m_running = false;
+  std::atomic<bool> m_stop{false};
+#ifdef ESP8266NDN_PORT_QUEUE_FREERTOS
+  TaskHandle_t m_task = nullptr;
+  std::atomic<bool> m_taskExited{false};
+#else
+  pthread_t m_thread;
+  sem_t m_wake;
+#endif
+};
+
+} // namespace esp8266ndn
+
+#endif
+#endif // ESP8266NDN_APP_CRYPTO_WORKER_HPP
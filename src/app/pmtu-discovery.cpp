@@ -0,0 +1,185 @@
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32) ||                                \
+  defined(ARDUINO_ARCH_RP2040) || defined(__linux__)
+
+#include "pmtu-discovery.hpp"
+#include "../core/logger.hpp"
+#include "../transport/tlv-decode.hpp"
+
+#define LOG(...) LOGGER(PmtuDiscovery, __VA_ARGS__)
+
+namespace esp8266ndn {
+
+namespace {
+
+using detail::sizeofVarNum;
+using detail::TtLpFragment;
+using detail::TtLpPacket;
+using detail::TtLpPadding;
+using detail::writeVarNum;
+
+/**
+ * @brief Wrap an Interest in an LpPacket padded to at most @p size octets.
+ * @return LpPacket length, or 0 if the Interest does not fit.
+ */
+size_t
+makeProbe(uint8_t* buf, size_t size, const uint8_t* interest, size_t interestLen) {
+  size_t fragLen = sizeofVarNum(TtLpFragment) + sizeofVarNum(interestLen) + interestLen;
+  auto innerLen = [=](size_t padLen) {
+    return sizeofVarNum(TtLpPadding) + sizeofVarNum(padLen) + padLen + fragLen;
+  };
+  auto totalLen = [=](size_t padLen) {
+    size_t inner = innerLen(padLen);
+    return sizeofVarNum(TtLpPacket) + sizeofVarNum(inner) + inner;
+  };
+
+  if (totalLen(0) > size) {
+    return 0;
+  }
+  size_t padLen = size - totalLen(0);
+  while (padLen > 0 && totalLen(padLen) > size) {
+    --padLen;
+  }
+
+  uint8_t* pos = buf;
+  pos = writeVarNum(pos, TtLpPacket);
+  pos = writeVarNum(pos, innerLen(padLen));
+  pos = writeVarNum(pos, TtLpPadding);
+  pos = writeVarNum(pos, padLen);
+  std::fill_n(pos, padLen, 0);
+  pos += padLen;
+  pos = writeVarNum(pos, TtLpFragment);
+  pos = writeVarNum(pos, interestLen);
+  pos = std::copy_n(interest, interestLen, pos);
+  return pos - buf;
+}
+
+} // anonymous namespace
+
+PmtuDiscovery::PmtuDiscovery(ndnph::Face& face, UdpTransport& transport,
+                             const ndnph::Name& prefix, size_t maxMtu)
+  : PacketHandler(face)
+  , m_transport(transport)
+  , m_prefix(prefix)
+  , m_maxMtu(static_cast<uint16_t>(std::min<size_t>(maxMtu, 0xFFFE))) {
+  m_buf.reset(new uint8_t[m_maxMtu]);
+}
+
+void
+PmtuDiscovery::begin(int interval) {
+  m_interval = std::max(0, interval);
+  ndnph::port::RandomSource::generate(reinterpret_cast<uint8_t*>(&m_seqNum), sizeof(m_seqNum));
+  restart();
+}
+
+void
+PmtuDiscovery::restart() {
+  m_state = State::PROBING;
+  m_lo = std::min<uint16_t>(BaseMtu, m_maxMtu);
+  m_hi = m_maxMtu + 1;
+  nextProbe();
+}
+
+void
+PmtuDiscovery::nextProbe() {
+  if (m_hi - m_lo <= Granularity) {
+    m_state = State::DONE;
+    m_deadline = ndnph::port::Clock::add(ndnph::port::Clock::now(), m_interval);
+    m_transport.setPathMtu(m_lo);
+    LOG(F("mtu=") << m_lo);
+    return;
+  }
+
+  // try the largest size first, because it works on most paths
+  m_probeSize = m_hi > m_maxMtu ? m_maxMtu : (m_lo + m_hi) / 2;
+  m_nAttempts = 0;
+  m_firstSeqNum = m_seqNum + 1;
+  sendProbe();
+}
+
+void
+PmtuDiscovery::sendProbe() {
+  ++m_seqNum;
+  ++m_nAttempts;
+  m_deadline = ndnph::port::Clock::add(ndnph::port::Clock::now(), ProbeTimeout);
+
+  ndnph::StaticRegion<512> region;
+  auto interest = region.create<ndnph::Interest>();
+  assert(!!interest);
+  interest.setName(m_prefix.append(region, ndnph::convention::Sequence(), m_seqNum));
+  interest.setMustBeFresh(true);
+  interest.setLifetime(ProbeTimeout);
+
+  ndnph::Encoder encoder(region);
+  encoder.prepend(interest);
+  encoder.trim();
+  if (!encoder) {
+    LOG(F("encode error"));
+    return;
+  }
+
+  size_t size = makeProbe(m_buf.get(), m_probeSize, encoder.begin(), encoder.size());
+  if (size <= m_lo) {
+    // probe cannot be made larger than known working size
+    m_hi = m_lo + 1;
+    nextProbe();
+    return;
+  }
+  m_probeSize = size;
+
+  if (!m_transport.sendUnfragmented(m_buf.get(), size)) {
+    LOG(F("send error size=") << size);
+  }
+}
+
+void
+PmtuDiscovery::loop() {
+  auto now = ndnph::port::Clock::now();
+  switch (m_state) {
+    case State::IDLE:
+      break;
+    case State::PROBING:
+      if (ndnph::port::Clock::isBefore(now, m_deadline)) {
+        break;
+      }
+      if (m_nAttempts < MaxAttempts) {
+        sendProbe();
+        break;
+      }
+      LOG(F("fail size=") << m_probeSize);
+      m_hi = m_probeSize;
+      nextProbe();
+      break;
+    case State::DONE:
+      if (m_interval > 0 && !ndnph::port::Clock::isBefore(now, m_deadline)) {
+        restart();
+      }
+      break;
+  }
+}
+
+bool
+PmtuDiscovery::processData(ndnph::Data data) {
+  auto name = data.getName();
+  if (m_state != State::PROBING || name.size() <= m_prefix.size() ||
+      !m_prefix.isPrefixOf(name)) {
+    return false;
+  }
+
+  auto comp = name[m_prefix.size()];
+  if (!comp.is<ndnph::convention::Sequence>()) {
+    return false;
+  }
+  uint64_t seqNum = comp.as<ndnph::convention::Sequence>();
+  if (seqNum > UINT32_MAX || static_cast<uint32_t>(seqNum) - m_firstSeqNum >= m_nAttempts) {
+    return false;
+  }
+
+  LOG(F("pass size=") << m_probeSize);
+  m_lo = m_probeSize;
+  nextProbe();
+  return true;
+}
+
+} // namespace esp8266ndn
+
+#endif // ARDUINO_ARCH_ESP8266 || ARDUINO_ARCH_ESP32 || ARDUINO_ARCH_RP2040 || __linux__
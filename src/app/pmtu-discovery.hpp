@@ -0,0 +1,97 @@
+#ifndef ESP8266NDN_APP_PMTU_DISCOVERY_HPP
+#define ESP8266NDN_APP_PMTU_DISCOVERY_HPP
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32) ||                                \
+  defined(ARDUINO_ARCH_RP2040) || defined(__linux__)
+
+#include "../transport/udp-transport.hpp"
+
+namespace esp8266ndn {
+
+/**
+ * @brief Discover path MTU of a UDP tunnel.
+ *
+ * This module requires a ping server reachable through the tunnel, which responds to any Interest
+ * under its prefix with a Data of the same name, such as ndnpingserver or @c ndnph::PingServer .
+ *
+ * Each probe is an Interest under the ping server prefix, wrapped in an NDNLPv2 packet that is
+ * padded to the probe size with an ignorable header field. The transport sends the probe directly,
+ * bypassing NDNLP fragmentation on the Face. If the Data comes back, the probe size fits in the
+ * path; if several probes of the same size are lost, the size is considered too large.
+ * The search starts from the largest candidate and bisects down to the largest working size,
+ * which is then reported to @c UdpTransport::setPathMtu . The transport fragments outgoing packets
+ * longer than this size.
+ */
+class PmtuDiscovery : public ndnph::PacketHandler {
+public:
+  /**
+   * @brief Constructor.
+   * @param face Face of @p transport .
+   * @param transport UDP transport in TUNNEL mode.
+   * @param prefix ping server prefix. It must remain valid.
+   * @param maxMtu largest probe size.
+   */
+  explicit PmtuDiscovery(ndnph::Face& face, UdpTransport& transport, const ndnph::Name& prefix,
+                         size_t maxMtu = UdpTransport::DefaultMtu);
+
+  /**
+   * @brief Start discovery.
+   * @param interval how often to repeat discovery (millis), 0 means once.
+   */
+  void begin(int interval = 600000);
+
+  /** @brief Determine whether the most recent discovery has completed. */
+  bool isDone() const {
+    return m_state == State::DONE;
+  }
+
+private:
+  void loop() final;
+
+  bool processData(ndnph::Data data) final;
+
+  void restart();
+
+  void nextProbe();
+
+  void sendProbe();
+
+public:
+  enum {
+    /** @brief Smallest size assumed to work, minimum IPv4 reassembly size minus headers. */
+    BaseMtu = 576 - 20 - 8,
+    /** @brief Search stops when upper and lower bounds are this close. */
+    Granularity = 8,
+    /** @brief Probes of the same size before considering it too large. */
+    MaxAttempts = 3,
+    /** @brief How long to wait for a probe response (millis). */
+    ProbeTimeout = 1000,
+  };
+
+private:
+  enum class State : uint8_t {
+    IDLE,
+    PROBING,
+    DONE,
+  };
+
+  UdpTransport& m_transport;
+  ndnph::Name m_prefix;
+  std::unique_ptr<uint8_t[]> m_buf; ///< probe buffer, m_maxMtu octets
+  ndnph::port::Clock::Time m_deadline;
+  int m_interval = 0;
+  uint32_t m_seqNum = 0;      ///< sequence number of last probe
+  uint32_t m_firstSeqNum = 0; ///< sequence number of first probe of current size
+  uint16_t m_maxMtu = 0;
+  uint16_t m_lo = 0;        ///< largest size known to work
+  uint16_t m_hi = 0;        ///< smallest size known to fail
+  uint16_t m_probeSize = 0; ///< size of outstanding probe
+  uint8_t m_nAttempts = 0;
+  State m_state = State::IDLE;
+};
+
+} // namespace esp8266ndn
+
+#endif // ARDUINO_ARCH_ESP8266 || ARDUINO_ARCH_ESP32 || ARDUINO_ARCH_RP2040 || __linux__
+
+#endif // ESP8266NDN_APP_PMTU_DISCOVERY_HPP
@@ -3,6 +3,10 @@
 
 #include "logging.hpp"
 
+#ifndef ARDUINO
+#define STREAMING_CONSOLE
+#endif
+
 #include "../vendor/Streaming.h"
 
 #undef min
@@ -8,15 +8,23 @@
 #ifndef ESP8266NDN_H
 #define ESP8266NDN_H
 
+#include "port/chacha-drbg.hpp"
 #include "port/port.hpp"
 
 #include "core/logging.hpp"
 
 #include "app/autoconfig.hpp"
+#include "app/crypto-worker.hpp"
+#include "app/pmtu-discovery.hpp"
 #include "app/unix-time.hpp"
 
 #include "transport/ble-server-transport.hpp"
+#include "transport/ble-tx-queue.hpp"
 #include "transport/ethernet-transport.hpp"
+#include "transport/lp-fragmentation.hpp"
+#include "transport/packet-filter.hpp"
+#include "transport/udp-endpoint-table.hpp"
 #include "transport/udp-transport.hpp"
+#include "transport/udp-tx-queue.hpp"
 
 #endif // ESP8266NDN_H
@@ -0,0 +1,127 @@
+#include "chacha-drbg.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace esp8266ndn {
+
+namespace {
+
+inline uint32_t
+rotl32(uint32_t x, int n) {
+  return (x << n) | (x >> (32 - n));
+}
+
+inline void
+quarterRound(uint32_t* x, int a, int b, int c, int d) {
+  x[a] += x[b];
+  x[d] = rotl32(x[d] ^ x[a], 16);
+  x[c] += x[d];
+  x[b] = rotl32(x[b] ^ x[c], 12);
+  x[a] += x[b];
+  x[d] = rotl32(x[d] ^ x[a], 8);
+  x[c] += x[d];
+  x[b] = rotl32(x[b] ^ x[c], 7);
+}
+
+/** @brief Compute ChaCha20 block with zero nonce, as 16 words. */
+void
+chachaBlock(const uint32_t key[8], uint32_t counter, uint32_t out[16]) {
+  uint32_t input[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+  std::copy_n(key, 8, &input[4]);
+  input[12] = counter;
+
+  std::copy_n(input, 16, out);
+  for (int i = 0; i < 10; ++i) {
+    quarterRound(out, 0, 4, 8, 12);
+    quarterRound(out, 1, 5, 9, 13);
+    quarterRound(out, 2, 6, 10, 14);
+    quarterRound(out, 3, 7, 11, 15);
+    quarterRound(out, 0, 5, 10, 15);
+    quarterRound(out, 1, 6, 11, 12);
+    quarterRound(out, 2, 7, 8, 13);
+    quarterRound(out, 3, 4, 9, 14);
+  }
+  for (int i = 0; i < 16; ++i) {
+    out[i] += input[i];
+  }
+}
+
+inline void
+storeLe32(uint8_t* pos, uint32_t w) {
+  pos[0] = w;
+  pos[1] = w >> 8;
+  pos[2] = w >> 16;
+  pos[3] = w >> 24;
+}
+
+} // anonymous namespace
+
+ChaChaDrbg::ChaChaDrbg(SeedFunc seed)
+  : m_seed(seed) {
+  std::fill_n(m_key, KeyLen / 4, 0);
+}
+
+ChaChaDrbg::~ChaChaDrbg() {
+  std::fill_n(m_key, KeyLen / 4, 0);
+  std::fill_n(m_buf, sizeof(m_buf), 0);
+}
+
+bool
+ChaChaDrbg::refill() {
+  if (m_untilReseed == 0) {
+    uint8_t entropy[KeyLen];
+    if (!m_seed(entropy, sizeof(entropy))) {
+      return false;
+    }
+    for (int i = 0; i < KeyLen / 4; ++i) {
+      m_key[i] ^= static_cast<uint32_t>(entropy[4 * i]) |
+                  (static_cast<uint32_t>(entropy[4 * i + 1]) << 8) |
+                  (static_cast<uint32_t>(entropy[4 * i + 2]) << 16) |
+                  (static_cast<uint32_t>(entropy[4 * i + 3]) << 24);
+    }
+    std::fill_n(entropy, sizeof(entropy), 0);
+    m_untilReseed = ReseedInterval;
+  }
+
+  uint32_t block[16];
+  uint32_t nextKey[KeyLen / 4];
+  for (int b = 0; b < BufferBlocks; ++b) {
+    chachaBlock(m_key, b, block);
+    int i = 0;
+    if (b == 0) {
+      // fast key erasure: first 32 octets become the next key and are never output
+      std::copy_n(block, KeyLen / 4, nextKey);
+      i = KeyLen / 4;
+    }
+    for (; i < 16; ++i) {
+      storeLe32(&m_buf[b * BlockLen + 4 * i], block[i]);
+    }
+  }
+  std::copy_n(nextKey, KeyLen / 4, m_key);
+  std::fill_n(nextKey, KeyLen / 4, 0);
+  std::fill_n(block, 16, 0);
+
+  m_avail = sizeof(m_buf) - KeyLen;
+  m_untilReseed -= std::min<size_t>(m_untilReseed, m_avail);
+  return true;
+}
+
+bool
+ChaChaDrbg::generate(uint8_t* output, size_t count) {
+  while (count > 0) {
+    if (m_avail == 0 && !refill()) {
+      return false;
+    }
+    size_t n = std::min(count, m_avail);
+    uint8_t* pos = &m_buf[sizeof(m_buf) - m_avail];
+    std::memcpy(output, pos, n);
+    std::memset(pos, 0, n);
+    output += n;
+    count -= n;
+    m_avail -= n;
+  }
+  return true;
+}
+
+} // namespace esp8266ndn
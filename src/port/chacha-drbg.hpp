@@ -0,0 +1,65 @@
+#ifndef ESP8266NDN_PORT_CHACHA_DRBG_HPP
+#define ESP8266NDN_PORT_CHACHA_DRBG_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esp8266ndn {
+
+/**
+ * @brief Random bytes generator based on ChaCha20 keystream.
+ *
+ * Keystream is generated several blocks at a time. The first 32 octets of each refill replace
+ * the key, and served octets are erased from the buffer, so that a state compromise does not
+ * reveal earlier output. Entropy from the seed function is mixed into the key before the first
+ * output and after every ReseedInterval octets.
+ *
+ * This class is not thread-safe.
+ */
+class ChaChaDrbg {
+public:
+  /**
+   * @brief Entropy source, such as a hardware random generator.
+   * @return whether success.
+   */
+  using SeedFunc = bool (*)(uint8_t* output, size_t count);
+
+  explicit ChaChaDrbg(SeedFunc seed);
+
+  ~ChaChaDrbg();
+
+  /**
+   * @brief Generate random octets.
+   * @return whether success; false if the seed function fails.
+   */
+  bool generate(uint8_t* output, size_t count);
+
+  /** @brief Mix fresh entropy into the key before the next refill. */
+  void reseed() {
+    m_untilReseed = 0;
+    m_avail = 0;
+  }
+
+public:
+  enum {
+    KeyLen = 32,
+    BlockLen = 64,
+    BufferBlocks = 4,
+    /** @brief Number of output octets between reseeds. */
+    ReseedInterval = 65536,
+  };
+
+private:
+  bool refill();
+
+private:
+  SeedFunc m_seed;
+  uint32_t m_key[KeyLen / 4];
+  uint8_t m_buf[BufferBlocks * BlockLen];
+  size_t m_avail = 0;
+  size_t m_untilReseed = 0;
+};
+
+} // namespace esp8266ndn
+
+#endif // ESP8266NDN_PORT_CHACHA_DRBG_HPP
@@ -54,6 +54,19 @@
 #define NDNPH_PORT_UNIXTIME_SYSTIME
 #define NDNPH_PORT_UNIXTIME_SYSTIME_CANSET
 
+#elif defined(__linux__)
+
+#define NDNPH_PORT_SHA256_CUSTOM
+#define ESP8266NDN_PORT_SHA256_CRYPTOSUITE
+
+#define NDNPH_PORT_EC_CUSTOM
+#define ESP8266NDN_PORT_EC_UECC
+
+#define NDNPH_PORT_QUEUE_CUSTOM
+#define ESP8266NDN_PORT_QUEUE_PTHREAD
+
+#define NDNPH_PORT_UNIXTIME_SYSTIME
+
 #else
 
 #error "Unknown ARDUINO_ARCH"
@@ -3,8 +3,21 @@
 
 #include "random.hpp"
 
+#if defined(ESP8266NDN_PORT_SHA256_BEARSSL)
+#include "sha256-bearssl.hpp"
+#elif defined(ESP8266NDN_PORT_SHA256_CRYPTOSUITE)
+#include "sha256-cryptosuite.hpp"
+#endif
+
 #include <algorithm>
 #include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+
+#ifdef ESP8266NDN_PORT_QUEUE_PTHREAD
+#include <pthread.h>
+#endif
 
 namespace esp8266ndn {
 namespace ndnph_port_uecc {
@@ -27,6 +40,217 @@ private:
 
 namespace {
 
+#ifdef ESP8266NDN_PORT_QUEUE_PTHREAD
+pthread_mutex_t stateMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/**
+ * @brief Guard the nonce pool, pinned keys, caches, and their counters.
+ *
+ * On Linux, CryptoWorker signs and verifies on its own thread while the application may refill
+ * the pool or change pinned keys from loop(). Other platforms with micro-ecc are single-threaded.
+ */
+class StateLock {
+public:
+#ifdef ESP8266NDN_PORT_QUEUE_PTHREAD
+  StateLock() {
+    pthread_mutex_lock(&stateMutex);
+  }
+
+  ~StateLock() {
+    pthread_mutex_unlock(&stateMutex);
+  }
+#else
+  StateLock() {}
+#endif
+
+  StateLock(const StateLock&) = delete;
+  StateLock& operator=(const StateLock&) = delete;
+};
+
+struct NoncePoolEntry {
+  uint8_t kInv[uECC_BYTES];
+  uint8_t r[uECC_BYTES];
+};
+
+struct NoncePoolState {
+  std::unique_ptr<NoncePoolEntry[]> entries;
+  size_t capacity = 0;
+  size_t size = 0;
+  EcNoncePool::Counters cnt;
+};
+
+NoncePoolState noncePool;
+
+struct PinnedKey {
+  uint8_t key[2 * uECC_BYTES];
+  std::unique_ptr<uint64_t[]> table;
+  int teeth = 0;
+};
+
+struct PinnedKeysState {
+  PinnedKey keys[EcPinnedKeys::MaxPinned];
+  std::unique_ptr<uint64_t[]> generatorTables[EcPinnedKeys::MaxTeeth + 1];
+  EcPinnedKeys::Counters cnt;
+};
+
+PinnedKeysState pinnedKeys;
+
+std::unique_ptr<uint64_t[]>
+makeCombTable(const uint8_t* point, int teeth) {
+  std::unique_ptr<uint64_t[]> table(
+    new (std::nothrow) uint64_t[uECC_COMB_TABLE_SIZE(teeth) / sizeof(uint64_t)]);
+  if (table == nullptr || !uECC_comb_precompute(point, teeth, table.get())) {
+    table.reset();
+  }
+  return table;
+}
+
+/** @brief Find pinned key by raw public key, or return nullptr. */
+PinnedKey*
+findPinnedKey(const uint8_t* key) {
+  for (PinnedKey& pinned : pinnedKeys.keys) {
+    if (pinned.teeth != 0 && std::equal(key, key + sizeof(pinned.key), pinned.key)) {
+      return &pinned;
+    }
+  }
+  return nullptr;
+}
+
+struct ValidKey {
+  uint32_t hash = 0;
+  bool isValid = false;
+  uint8_t key[2 * uECC_BYTES];
+};
+
+struct ValidKeyCacheState {
+  ValidKey entries[EcValidKeyCache::Capacity];
+  size_t next = 0;
+  EcValidKeyCache::Counters cnt;
+};
+
+ValidKeyCacheState validKeys;
+
+/** @brief Compute 32-bit FNV-1a hash of a raw public key. */
+uint32_t
+hashKey(const uint8_t* key) {
+  uint32_t h = 0x811C9DC5;
+  for (size_t i = 0; i < 2 * uECC_BYTES; ++i) {
+    h = (h ^ key[i]) * 0x01000193;
+  }
+  return h;
+}
+
+/** @brief Validate raw public key, consulting and updating the cache. */
+bool
+validateKey(const uint8_t* key) {
+  uint32_t h = hashKey(key);
+  {
+    StateLock lock;
+    for (const ValidKey& entry : validKeys.entries) {
+      if (entry.isValid && entry.hash == h && std::equal(key, key + sizeof(entry.key), entry.key)) {
+        ++validKeys.cnt.nHits;
+        return true;
+      }
+    }
+    ++validKeys.cnt.nMisses;
+  }
+
+  if (!uECC_valid_public_key(key)) {
+    return false;
+  }
+  StateLock lock;
+  ValidKey& entry = validKeys.entries[validKeys.next];
+  validKeys.next = (validKeys.next + 1) % EcValidKeyCache::Capacity;
+  entry.hash = h;
+  entry.isValid = true;
+  std::copy_n(key, sizeof(entry.key), entry.key);
+  return true;
+}
+
+constexpr size_t FingerprintLen = 32;
+
+struct VerifyCacheState {
+  /** @brief Fingerprints, most recently used first. */
+  uint8_t entries[EcVerifyCache::Capacity][FingerprintLen];
+  size_t size = 0;
+  EcVerifyCache::Counters cnt;
+};
+
+VerifyCacheState verifyCache;
+
+/** @brief Compute fingerprint of a verification. */
+void
+computeFingerprint(const uint8_t* key, const uint8_t* digest, const uint8_t* rawSig,
+                   uint8_t fingerprint[FingerprintLen]) {
+  ndnph_port::Sha256 hash;
+  hash.update(key, 2 * uECC_BYTES);
+  hash.update(digest, uECC_BYTES);
+  hash.update(rawSig, 2 * uECC_BYTES);
+  hash.final(fingerprint);
+}
+
+/** @brief Move the entry at @p index to the front. */
+void
+promoteVerifyCacheEntry(size_t index, const uint8_t fingerprint[FingerprintLen]) {
+  std::memmove(verifyCache.entries[1], verifyCache.entries[0], index * FingerprintLen);
+  std::copy_n(fingerprint, FingerprintLen, verifyCache.entries[0]);
+}
+
+/** @brief Determine whether a verification is cached, and promote it to most recently used. */
+bool
+findVerifyCache(const uint8_t fingerprint[FingerprintLen]) {
+  for (size_t i = 0; i < verifyCache.size; ++i) {
+    if (std::equal(fingerprint, fingerprint + FingerprintLen, verifyCache.entries[i])) {
+      promoteVerifyCacheEntry(i, fingerprint);
+      return true;
+    }
+  }
+  return false;
+}
+
+/** @brief Insert a successful verification as most recently used. */
+void
+insertVerifyCache(const uint8_t fingerprint[FingerprintLen]) {
+  if (verifyCache.size < EcVerifyCache::Capacity) {
+    ++verifyCache.size;
+  }
+  promoteVerifyCacheEntry(verifyCache.size - 1, fingerprint);
+}
+
+/** @brief Release generator comb tables that are no longer used by any pinned key. */
+void
+releaseGeneratorTables() {
+  for (int teeth = EcPinnedKeys::MinTeeth; teeth <= EcPinnedKeys::MaxTeeth; ++teeth) {
+    bool inUse = std::any_of(std::begin(pinnedKeys.keys), std::end(pinnedKeys.keys),
+                             [=](const PinnedKey& pinned) { return pinned.teeth == teeth; });
+    if (!inUse) {
+      pinnedKeys.generatorTables[teeth].reset();
+    }
+  }
+}
+
+void
+eraseNonce(NoncePoolEntry& entry) {
+  volatile uint8_t* p = reinterpret_cast<volatile uint8_t*>(&entry);
+  for (size_t i = 0; i < sizeof(entry); ++i) {
+    p[i] = 0;
+  }
+}
+
+/** @brief Remove an entry from the nonce pool and erase it; k^-1 must not leave this file. */
+bool
+takeNonce(uint8_t kInv[uECC_BYTES], uint8_t r[uECC_BYTES]) {
+  if (noncePool.size == 0) {
+    return false;
+  }
+  NoncePoolEntry& entry = noncePool.entries[--noncePool.size];
+  std::copy_n(entry.kInv, uECC_BYTES, kInv);
+  std::copy_n(entry.r, uECC_BYTES, r);
+  eraseNonce(entry);
+  return true;
+}
+
 enum {
   ASN1_SEQUENCE = 0x30,
   ASN1_INTEGER = 0x02,
@@ -138,7 +362,25 @@ Ec::PrivateKey::import(const uint8_t key[Curve::PubLen::value]) {
 ssize_t
 Ec::PrivateKey::sign(const uint8_t digest[uECC_BYTES], uint8_t sig[Curve::MaxSigLen::value]) const {
   UeccSetRng::once();
-  bool ok = uECC_sign(m_key, digest, &sig[8]);
+  bool ok = false;
+  uint8_t kInv[uECC_BYTES], r[uECC_BYTES];
+  bool hasNonce = false;
+  {
+    // each entry must be taken by exactly one signature: a reused nonce reveals the private key
+    StateLock lock;
+    hasNonce = takeNonce(kInv, r);
+    if (hasNonce) {
+      ++noncePool.cnt.nHits;
+    } else {
+      ++noncePool.cnt.nMisses;
+    }
+  }
+  if (hasNonce) {
+    ok = uECC_sign_precomputed(m_key, digest, kInv, r, &sig[8]);
+    std::fill_n(static_cast<volatile uint8_t*>(kInv), sizeof(kInv), 0);
+  } else {
+    ok = uECC_sign(m_key, digest, &sig[8]);
+  }
   if (!ok) {
     return -1;
   }
@@ -151,7 +393,7 @@ Ec::PublicKey::import(const uint8_t key[Curve::PubLen::value]) {
     return false;
   }
   std::copy_n(&key[1], sizeof(m_key), m_key);
-  return uECC_valid_public_key(m_key);
+  return validateKey(m_key);
 }
 
 bool
@@ -160,7 +402,38 @@ Ec::PublicKey::verify(const uint8_t digest[uECC_BYTES], const uint8_t* sig, size
   if (!decodeSignatureBits(sig, sigLen, rawSig)) {
     return false;
   }
-  return uECC_verify(m_key, digest, rawSig);
+
+  uint8_t fingerprint[FingerprintLen];
+  computeFingerprint(m_key, digest, rawSig, fingerprint);
+  {
+    StateLock lock;
+    if (findVerifyCache(fingerprint)) {
+      ++verifyCache.cnt.nHits;
+      return true;
+    }
+    ++verifyCache.cnt.nMisses;
+
+    // comb tables are released by unpin, so they are used while holding the lock
+    const PinnedKey* pinned = findPinnedKey(m_key);
+    if (pinned != nullptr) {
+      ++pinnedKeys.cnt.nHits;
+      bool ok = uECC_verify_comb(pinned->table.get(),
+                                 pinnedKeys.generatorTables[pinned->teeth].get(), pinned->teeth,
+                                 digest, rawSig);
+      if (ok) {
+        insertVerifyCache(fingerprint);
+      }
+      return ok;
+    }
+    ++pinnedKeys.cnt.nMisses;
+  }
+
+  bool ok = uECC_verify(m_key, digest, rawSig);
+  if (ok) {
+    StateLock lock;
+    insertVerifyCache(fingerprint);
+  }
+  return ok;
 }
 
 bool
@@ -171,6 +444,166 @@ Ec::generateKey(uint8_t pvt[Curve::PvtLen::value], uint8_t pub[Curve::PubLen::va
 }
 
 } // namespace ndnph_port_uecc
+
+using ndnph_port_uecc::NoncePoolEntry;
+using ndnph_port_uecc::noncePool;
+using ndnph_port_uecc::PinnedKey;
+using ndnph_port_uecc::pinnedKeys;
+using ndnph_port_uecc::StateLock;
+
+bool
+EcNoncePool::resize(size_t capacity) {
+  StateLock lock;
+  for (size_t i = 0; i < noncePool.size; ++i) {
+    ndnph_port_uecc::eraseNonce(noncePool.entries[i]);
+  }
+  noncePool.size = 0;
+  noncePool.entries.reset(capacity == 0 ? nullptr : new (std::nothrow) NoncePoolEntry[capacity]);
+  if (capacity > 0 && noncePool.entries == nullptr) {
+    noncePool.capacity = 0;
+    return false;
+  }
+  noncePool.capacity = capacity;
+  return true;
+}
+
+size_t
+EcNoncePool::capacity() {
+  StateLock lock;
+  return noncePool.capacity;
+}
+
+size_t
+EcNoncePool::size() {
+  StateLock lock;
+  return noncePool.size;
+}
+
+bool
+EcNoncePool::refill() {
+  if (size() >= capacity()) {
+    return false;
+  }
+
+  // precompute without holding the lock, so that a concurrent signature is not delayed
+  ndnph_port_uecc::UeccSetRng::once();
+  NoncePoolEntry entry;
+  bool ok = uECC_precompute_nonce(entry.kInv, entry.r);
+  if (ok) {
+    StateLock lock;
+    ok = noncePool.size < noncePool.capacity;
+    if (ok) {
+      noncePool.entries[noncePool.size++] = entry;
+    }
+  }
+  ndnph_port_uecc::eraseNonce(entry);
+  return ok;
+}
+
+EcNoncePool::Counters
+EcNoncePool::readCounters() {
+  StateLock lock;
+  return noncePool.cnt;
+}
+
+bool
+EcPinnedKeys::pin(const uint8_t key[ndnph_port_uecc::Ec::Curve::PubLen::value], int teeth) {
+  if (teeth < MinTeeth || teeth > MaxTeeth || key[0] != 0x04 || !uECC_valid_public_key(&key[1])) {
+    return false;
+  }
+
+  StateLock lock;
+  PinnedKey* pinned = ndnph_port_uecc::findPinnedKey(&key[1]);
+  if (pinned == nullptr) {
+    auto it = std::find_if(std::begin(pinnedKeys.keys), std::end(pinnedKeys.keys),
+                           [](const PinnedKey& p) { return p.teeth == 0; });
+    if (it == std::end(pinnedKeys.keys)) {
+      return false;
+    }
+    pinned = it;
+  } else if (pinned->teeth == teeth) {
+    return true;
+  }
+
+  auto& generatorTable = pinnedKeys.generatorTables[teeth];
+  if (generatorTable == nullptr) {
+    generatorTable = ndnph_port_uecc::makeCombTable(nullptr, teeth);
+  }
+  auto table = ndnph_port_uecc::makeCombTable(&key[1], teeth);
+  if (generatorTable == nullptr || table == nullptr) {
+    ndnph_port_uecc::releaseGeneratorTables();
+    return false;
+  }
+
+  std::copy_n(&key[1], sizeof(pinned->key), pinned->key);
+  pinned->table = std::move(table);
+  pinned->teeth = teeth;
+  ndnph_port_uecc::releaseGeneratorTables();
+  return true;
+}
+
+bool
+EcPinnedKeys::unpin(const uint8_t key[ndnph_port_uecc::Ec::Curve::PubLen::value]) {
+  StateLock lock;
+  PinnedKey* pinned = ndnph_port_uecc::findPinnedKey(&key[1]);
+  if (key[0] != 0x04 || pinned == nullptr) {
+    return false;
+  }
+  pinned->table.reset();
+  pinned->teeth = 0;
+  ndnph_port_uecc::releaseGeneratorTables();
+  return true;
+}
+
+void
+EcPinnedKeys::clear() {
+  StateLock lock;
+  for (PinnedKey& pinned : pinnedKeys.keys) {
+    pinned.table.reset();
+    pinned.teeth = 0;
+  }
+  ndnph_port_uecc::releaseGeneratorTables();
+}
+
+size_t
+EcPinnedKeys::size() {
+  StateLock lock;
+  return std::count_if(std::begin(pinnedKeys.keys), std::end(pinnedKeys.keys),
+                       [](const PinnedKey& pinned) { return pinned.teeth != 0; });
+}
+
+EcPinnedKeys::Counters
+EcPinnedKeys::readCounters() {
+  StateLock lock;
+  return pinnedKeys.cnt;
+}
+
+void
+EcValidKeyCache::clear() {
+  StateLock lock;
+  for (auto& entry : ndnph_port_uecc::validKeys.entries) {
+    entry.isValid = false;
+  }
+}
+
+EcValidKeyCache::Counters
+EcValidKeyCache::readCounters() {
+  StateLock lock;
+  return ndnph_port_uecc::validKeys.cnt;
+}
+
+void
+EcVerifyCache::clear() {
+  StateLock lock;
+  ndnph_port_uecc::verifyCache.size = 0;
+}
+
+EcVerifyCache::Counters
+EcVerifyCache::readCounters() {
+  StateLock lock;
+  return ndnph_port_uecc::verifyCache.cnt;
+}
+
 } // namespace esp8266ndn
 
 #endif // ESP8266NDN_PORT_EC_UECC
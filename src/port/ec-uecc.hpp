@@ -6,6 +6,7 @@
 #ifdef ESP8266NDN_PORT_EC_UECC
 
 #include "../vendor/uECC.h"
+#include <cstdint>
 #include <sys/types.h>
 #include <type_traits>
 
@@ -45,6 +46,176 @@ public:
 };
 
 } // namespace ndnph_port_uecc
+
+/**
+ * @brief Pool of precomputed ECDSA nonces for the micro-ecc port.
+ *
+ * Each entry holds k^-1 and r, which do not depend on the private key. When an entry is available,
+ * signing consumes it and skips the k*G scalar multiplication; otherwise, signing computes a nonce
+ * online. The pool is empty with zero capacity by default.
+ *
+ * This may be refilled from loop() while CryptoWorker signs on another thread; each entry is
+ * consumed by exactly one signature.
+ */
+class EcNoncePool {
+public:
+  struct Counters {
+    /** @brief Signatures made with a precomputed nonce. */
+    uint32_t nHits = 0;
+    /** @brief Signatures made with an online nonce, because the pool is empty. */
+    uint32_t nMisses = 0;
+  };
+
+  EcNoncePool() = delete;
+
+  /**
+   * @brief Change pool capacity.
+   * @param capacity number of entries; 0 disables the pool.
+   * @return whether success; false if memory allocation fails, in which case the pool is disabled.
+   *
+   * Existing entries are discarded.
+   */
+  static bool resize(size_t capacity);
+
+  static size_t capacity();
+
+  /** @brief Return number of precomputed entries. */
+  static size_t size();
+
+  /**
+   * @brief Precompute one entry, if the pool is not full.
+   * @return whether an entry was added.
+   *
+   * This should be invoked in loop() during idle time. Each invocation performs at most one scalar
+   * multiplication, which takes hundreds of milliseconds on ESP8266 and nRF52.
+   */
+  static bool refill();
+
+  /** @brief Read counters. */
+  static Counters readCounters();
+};
+
+/**
+ * @brief Public keys pinned for fast ECDSA verification in the micro-ecc port.
+ *
+ * Each pinned key has a precomputed comb table of (2^teeth - 1) points, 64 octets each. Pinned
+ * keys with the same number of teeth share a comb table of the curve generator of the same size.
+ * Ec::PublicKey::verify uses these tables if its key is pinned, which is several times faster
+ * than the generic double-scalar multiplication.
+ *
+ * Keys may be pinned or unpinned from loop() while CryptoWorker verifies on another thread.
+ */
+class EcPinnedKeys {
+public:
+  struct Counters {
+    /** @brief Verifications with comb tables. */
+    uint32_t nHits = 0;
+    /** @brief Verifications without comb tables, because the key is not pinned. */
+    uint32_t nMisses = 0;
+  };
+
+  EcPinnedKeys() = delete;
+
+  /**
+   * @brief Pin a public key, or change the number of teeth of a pinned key.
+   * @param key uncompressed public key, such as the last 65 octets of SubjectPublicKeyInfo.
+   * @param teeth number of comb teeth. Each additional tooth roughly doubles RAM usage and
+   *              reduces point doublings in verification.
+   * @return whether success; false if the key is invalid or MaxPinned keys are pinned.
+   *
+   * This takes several scalar multiplications worth of time.
+   */
+  static bool pin(const uint8_t key[ndnph_port_uecc::Ec::Curve::PubLen::value],
+                  int teeth = DefaultTeeth);
+
+  /**
+   * @brief Unpin a public key and release its comb table.
+   * @return whether the key was pinned.
+   */
+  static bool unpin(const uint8_t key[ndnph_port_uecc::Ec::Curve::PubLen::value]);
+
+  /** @brief Unpin all public keys and release all comb tables. */
+  static void clear();
+
+  /** @brief Return number of pinned keys. */
+  static size_t size();
+
+  /** @brief Read counters. */
+  static Counters readCounters();
+
+public:
+  enum {
+    MinTeeth = uECC_COMB_MIN_TEETH,
+    MaxTeeth = uECC_COMB_MAX_TEETH,
+    /** @brief Default teeth, using 960 octets per table. */
+    DefaultTeeth = 4,
+    MaxPinned = 4,
+  };
+};
+
+/**
+ * @brief Cache of public keys that passed validation in the micro-ecc port.
+ *
+ * Ec::PublicKey::import validates the point with an on-curve check. Keys that pass are remembered
+ * here, so that importing the same key again, such as a certificate key decoded into a short-lived
+ * region for every packet, costs only a lookup.
+ */
+class EcValidKeyCache {
+public:
+  struct Counters {
+    /** @brief Imports that found the key in the cache. */
+    uint32_t nHits = 0;
+    /** @brief Imports that validated the key. */
+    uint32_t nMisses = 0;
+  };
+
+  EcValidKeyCache() = delete;
+
+  /** @brief Forget all cached keys. */
+  static void clear();
+
+  /** @brief Read counters. */
+  static Counters readCounters();
+
+public:
+  enum {
+    Capacity = 4,
+  };
+};
+
+/**
+ * @brief Cache of successful ECDSA verifications in the micro-ecc port.
+ *
+ * Each entry is a SHA-256 fingerprint of public key, signed portion digest, and signature.
+ * Ec::PublicKey::verify consults this cache before the scalar multiplications, so that a duplicate
+ * of a verified packet, such as signed Data received from several routers on a multicast face,
+ * costs one hash. Failed verifications are not cached. Least recently used entries are evicted.
+ *
+ * This cache is unavailable on ESP32, where ECDSA is provided by the mbed TLS port in NDNph.
+ */
+class EcVerifyCache {
+public:
+  struct Counters {
+    /** @brief Verifications found in the cache. */
+    uint32_t nHits = 0;
+    /** @brief Verifications computed. */
+    uint32_t nMisses = 0;
+  };
+
+  EcVerifyCache() = delete;
+
+  /** @brief Forget all cached verifications. */
+  static void clear();
+
+  /** @brief Read counters. */
+  static Counters readCounters();
+
+public:
+  enum {
+    Capacity = 8,
+  };
+};
+
 } // namespace esp8266ndn
 
 namespace ndnph {
@@ -17,6 +17,83 @@
 #define FSPORT_FILESYSTEM (::InternalFS)
 #define FSPORT_READ (::Adafruit_LittleFS_Namespace::FILE_O_READ)
 #define FSPORT_WRITE (::Adafruit_LittleFS_Namespace::FILE_O_WRITE)
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/** @brief Subset of Arduino File API over a POSIX file descriptor. */
+class PosixFile {
+public:
+  explicit PosixFile(int fd)
+    : m_fd(fd) {}
+
+  explicit operator bool() const {
+    return m_fd >= 0;
+  }
+
+  size_t size() const {
+    struct stat st;
+    return ::fstat(m_fd, &st) == 0 ? st.st_size : 0;
+  }
+
+  size_t read(uint8_t* buffer, size_t count) {
+    ssize_t n = ::read(m_fd, buffer, count);
+    return n < 0 ? 0 : n;
+  }
+
+  size_t write(const uint8_t* buffer, size_t count) {
+    ssize_t n = ::write(m_fd, buffer, count);
+    return n < 0 ? 0 : n;
+  }
+
+  void close() {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+
+private:
+  int m_fd;
+};
+
+/**
+ * @brief Subset of Arduino FS API over POSIX filesystem.
+ *
+ * Absolute paths used by FileStore are interpreted relative to the current working directory.
+ */
+class PosixFs {
+public:
+  bool mkdir(const char* path) {
+    return ::mkdir(relative(path), 0700) == 0;
+  }
+
+  PosixFile open(const char* path, int flags) {
+    return PosixFile(::open(relative(path), flags | O_CLOEXEC, 0600));
+  }
+
+  bool remove(const char* path) {
+    return ::unlink(relative(path)) == 0;
+  }
+
+  bool exists(const char* path) {
+    return ::access(relative(path), F_OK) == 0;
+  }
+
+private:
+  static const char* relative(const char* path) {
+    return path[0] == '/' ? &path[1] : path;
+  }
+};
+
+PosixFs posixFs;
+
+} // anonymous namespace
+
+#define FSPORT_FILESYSTEM (posixFs)
+#define FSPORT_READ (O_RDONLY)
+#define FSPORT_WRITE (O_WRONLY | O_CREAT | O_TRUNC)
 #endif
 
 namespace esp8266ndn {
@@ -7,7 +7,11 @@
 namespace esp8266ndn {
 namespace ndnph_port {
 
-/** @brief File storage on microcontroller filesystem. */
+/**
+ * @brief File storage on microcontroller filesystem.
+ *
+ * Linux: directories are created under the current working directory.
+ */
 class FileStore {
 public:
   bool open(const char* path);
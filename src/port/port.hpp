@@ -19,6 +19,10 @@
 #include "queue-freertos.hpp"
 #endif
 
+#ifdef ESP8266NDN_PORT_QUEUE_PTHREAD
+#include "queue-pthread.hpp"
+#endif
+
 #define NDNPH_PORT_FS_CUSTOM
 #include "fs.hpp"
 
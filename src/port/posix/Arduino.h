@@ -0,0 +1,43 @@
+#ifndef ESP8266NDN_PORT_POSIX_ARDUINO_H
+#define ESP8266NDN_PORT_POSIX_ARDUINO_H
+
+/**
+ * @file
+ * Subset of Arduino core API for building esp8266ndn on Linux.
+ *
+ * Add this directory to the include path, so that library sources see it as @c <Arduino.h> .
+ */
+
+#include "IPAddress.h"
+#include "Print.h"
+#include "Printable.h"
+#include "pgmspace.h"
+
+#include <cstdint>
+#include <cstring>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+typedef uint8_t byte;
+
+/** @brief Return milliseconds since process start. */
+unsigned long
+millis();
+
+/** @brief Return microseconds since process start. */
+unsigned long
+micros();
+
+void
+delay(unsigned long ms);
+
+void
+delayMicroseconds(unsigned int us);
+
+void
+yield();
+
+#endif // ESP8266NDN_PORT_POSIX_ARDUINO_H
@@ -0,0 +1,63 @@
+#ifndef ESP8266NDN_PORT_POSIX_IPADDRESS_H
+#define ESP8266NDN_PORT_POSIX_IPADDRESS_H
+
+#include "Printable.h"
+
+#include <cstdint>
+#include <cstring>
+#include <netinet/in.h>
+
+/** @brief IPv4 address, compatible with Arduino IPAddress class. */
+class IPAddress : public Printable {
+public:
+  IPAddress() = default;
+
+  IPAddress(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3)
+    : m_addr{b0, b1, b2, b3} {}
+
+  /** @brief Construct from address in network byte order. */
+  IPAddress(uint32_t addr) {
+    std::memcpy(m_addr, &addr, sizeof(m_addr));
+  }
+
+  IPAddress(const uint8_t* addr) {
+    std::memcpy(m_addr, addr, sizeof(m_addr));
+  }
+
+  /** @brief Return address in network byte order. */
+  operator uint32_t() const {
+    uint32_t addr = 0;
+    std::memcpy(&addr, m_addr, sizeof(m_addr));
+    return addr;
+  }
+
+  bool operator==(const IPAddress& other) const {
+    return std::memcmp(m_addr, other.m_addr, sizeof(m_addr)) == 0;
+  }
+
+  bool operator!=(const IPAddress& other) const {
+    return !(*this == other);
+  }
+
+  uint8_t operator[](int index) const {
+    return m_addr[index];
+  }
+
+  uint8_t& operator[](int index) {
+    return m_addr[index];
+  }
+
+  bool isSet() const {
+    return static_cast<uint32_t>(*this) != 0;
+  }
+
+  /** @brief Parse dotted decimal notation. */
+  bool fromString(const char* str);
+
+  size_t printTo(Print& p) const override;
+
+private:
+  uint8_t m_addr[4] = {0, 0, 0, 0};
+};
+
+#endif // ESP8266NDN_PORT_POSIX_IPADDRESS_H
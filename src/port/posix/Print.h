@@ -0,0 +1,111 @@
+#ifndef ESP8266NDN_PORT_POSIX_PRINT_H
+#define ESP8266NDN_PORT_POSIX_PRINT_H
+
+#include "Printable.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+/** @brief Character output stream, compatible with Arduino Print class. */
+class Print {
+public:
+  virtual ~Print() = default;
+
+  virtual size_t write(uint8_t c) = 0;
+
+  virtual size_t write(const uint8_t* buffer, size_t size);
+
+  size_t write(const char* str) {
+    return str == nullptr ? 0 : write(reinterpret_cast<const uint8_t*>(str), std::strlen(str));
+  }
+
+  size_t write(const char* buffer, size_t size) {
+    return write(reinterpret_cast<const uint8_t*>(buffer), size);
+  }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  size_t print(const __FlashStringHelper* str) {
+    return write(reinterpret_cast<const char*>(str));
+  }
+
+  size_t print(const char* str) {
+    return write(str);
+  }
+
+  size_t print(char c) {
+    return write(static_cast<uint8_t>(c));
+  }
+
+  size_t print(unsigned char n, int base = 10) {
+    return print(static_cast<unsigned long long>(n), base);
+  }
+
+  size_t print(int n, int base = 10) {
+    return print(static_cast<long long>(n), base);
+  }
+
+  size_t print(unsigned int n, int base = 10) {
+    return print(static_cast<unsigned long long>(n), base);
+  }
+
+  size_t print(long n, int base = 10) {
+    return print(static_cast<long long>(n), base);
+  }
+
+  size_t print(unsigned long n, int base = 10) {
+    return print(static_cast<unsigned long long>(n), base);
+  }
+
+  size_t print(long long n, int base = 10);
+
+  size_t print(unsigned long long n, int base = 10);
+
+  size_t print(double n, int digits = 2);
+
+  size_t print(const Printable& x) {
+    return x.printTo(*this);
+  }
+
+  size_t println() {
+    return write("\r\n");
+  }
+
+  template<typename T>
+  size_t println(const T& x) {
+    size_t n = print(x);
+    return n + println();
+  }
+
+  template<typename T>
+  size_t println(const T& x, int base) {
+    size_t n = print(x, base);
+    return n + println();
+  }
+};
+
+/** @brief Print to a stdio stream, such as stdout or stderr. */
+class FilePrint : public Print {
+public:
+  explicit FilePrint(FILE* file)
+    : m_file(file) {}
+
+  size_t write(uint8_t c) override {
+    return std::fputc(c, m_file) == EOF ? 0 : 1;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    return std::fwrite(buffer, 1, size, m_file);
+  }
+
+  using Print::write;
+
+private:
+  FILE* m_file;
+};
+
+#endif // ESP8266NDN_PORT_POSIX_PRINT_H
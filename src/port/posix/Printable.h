@@ -0,0 +1,16 @@
+#ifndef ESP8266NDN_PORT_POSIX_PRINTABLE_H
+#define ESP8266NDN_PORT_POSIX_PRINTABLE_H
+
+#include <cstddef>
+
+class Print;
+
+/** @brief Object that can print itself to a Print. */
+class Printable {
+public:
+  virtual ~Printable() = default;
+
+  virtual size_t printTo(Print& p) const = 0;
+};
+
+#endif // ESP8266NDN_PORT_POSIX_PRINTABLE_H
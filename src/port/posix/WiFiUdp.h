@@ -0,0 +1,88 @@
+#ifndef ESP8266NDN_PORT_POSIX_WIFIUDP_H
+#define ESP8266NDN_PORT_POSIX_WIFIUDP_H
+
+#include "IPAddress.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief UDP socket, compatible with the subset of ESP8266 WiFiUDP API used by UdpTransport.
+ *
+ * Sockets are non-blocking. parsePacket() peeks at the next datagram, and read() receives it
+ * directly into the caller's buffer.
+ */
+class WiFiUDP {
+public:
+  WiFiUDP() = default;
+
+  ~WiFiUDP() {
+    stop();
+  }
+
+  WiFiUDP(const WiFiUDP&) = delete;
+  WiFiUDP& operator=(const WiFiUDP&) = delete;
+
+  /** @brief Bind to a local port on all interfaces. */
+  uint8_t begin(uint16_t port);
+
+  /** @brief Bind to a local port and join a multicast group. */
+  uint8_t beginMulticast(IPAddress interfaceAddr, IPAddress multicast, uint16_t port);
+
+  void stop();
+
+  /**
+   * @brief Wait for the next datagram without blocking.
+   * @return datagram length, or 0 if none is available.
+   */
+  int parsePacket();
+
+  /** @brief Return remaining length of the current datagram. */
+  int available();
+
+  /** @brief Receive the current datagram; excess octets are discarded. */
+  int read(uint8_t* buffer, size_t len);
+
+  /** @brief Discard the current datagram. */
+  void flush();
+
+  IPAddress remoteIP() const {
+    return m_remoteIp;
+  }
+
+  uint16_t remotePort() const {
+    return m_remotePort;
+  }
+
+  int beginPacket(IPAddress ip, uint16_t port);
+
+  int beginPacketMulticast(IPAddress multicastAddress, uint16_t port, IPAddress interfaceAddress,
+                           int ttl = 1);
+
+  size_t write(uint8_t c) {
+    m_txBuf.push_back(c);
+    return 1;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) {
+    m_txBuf.insert(m_txBuf.end(), buffer, buffer + size);
+    return size;
+  }
+
+  int endPacket();
+
+private:
+  bool open(uint16_t port, bool reuse);
+
+private:
+  int m_fd = -1;
+  int m_rxLen = 0; ///< length of peeked datagram, 0 if none
+  IPAddress m_remoteIp;
+  uint16_t m_remotePort = 0;
+  IPAddress m_txIp;
+  uint16_t m_txPort = 0;
+  std::vector<uint8_t> m_txBuf;
+};
+
+#endif // ESP8266NDN_PORT_POSIX_WIFIUDP_H
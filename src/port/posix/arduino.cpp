@@ -0,0 +1,130 @@
+#if defined(__linux__)
+
+#include "Arduino.h"
+
+#include <cstdarg>
+#include <ctime>
+#include <arpa/inet.h>
+#include <sched.h>
+
+namespace {
+
+uint64_t
+monotonicMicros() {
+  static const uint64_t epoch = [] {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+  }();
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000 - epoch;
+}
+
+} // anonymous namespace
+
+unsigned long
+millis() {
+  return monotonicMicros() / 1000;
+}
+
+unsigned long
+micros() {
+  return monotonicMicros();
+}
+
+void
+delay(unsigned long ms) {
+  timespec ts{static_cast<time_t>(ms / 1000), static_cast<long>(ms % 1000) * 1000000};
+  while (nanosleep(&ts, &ts) != 0) {
+  }
+}
+
+void
+delayMicroseconds(unsigned int us) {
+  timespec ts{static_cast<time_t>(us / 1000000), static_cast<long>(us % 1000000) * 1000};
+  while (nanosleep(&ts, &ts) != 0) {
+  }
+}
+
+void
+yield() {
+  sched_yield();
+}
+
+size_t
+Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  for (size_t i = 0; i < size; ++i) {
+    n += write(buffer[i]);
+  }
+  return n;
+}
+
+size_t
+Print::printf(const char* format, ...) {
+  char buf[64];
+  va_list ap;
+  va_start(ap, format);
+  int len = std::vsnprintf(buf, sizeof(buf), format, ap);
+  va_end(ap);
+  if (len < 0) {
+    return 0;
+  }
+  if (static_cast<size_t>(len) < sizeof(buf)) {
+    return write(buf, len);
+  }
+
+  char* large = new char[len + 1];
+  va_start(ap, format);
+  std::vsnprintf(large, len + 1, format, ap);
+  va_end(ap);
+  size_t n = write(large, len);
+  delete[] large;
+  return n;
+}
+
+size_t
+Print::print(long long n, int base) {
+  if (n < 0 && base == 10) {
+    return print('-') + print(0ULL - static_cast<unsigned long long>(n), base);
+  }
+  return print(static_cast<unsigned long long>(n), base);
+}
+
+size_t
+Print::print(unsigned long long n, int base) {
+  if (base < 2 || base > 36) {
+    base = 10;
+  }
+  char buf[8 * sizeof(n) + 1];
+  char* str = &buf[sizeof(buf)];
+  do {
+    int digit = n % base;
+    n /= base;
+    *--str = digit < 10 ? '0' + digit : 'A' + digit - 10;
+  } while (n > 0);
+  return write(str, &buf[sizeof(buf)] - str);
+}
+
+size_t
+Print::print(double n, int digits) {
+  return printf("%.*f", digits, n);
+}
+
+bool
+IPAddress::fromString(const char* str) {
+  in_addr addr;
+  if (inet_pton(AF_INET, str, &addr) != 1) {
+    return false;
+  }
+  *this = IPAddress(static_cast<uint32_t>(addr.s_addr));
+  return true;
+}
+
+size_t
+IPAddress::printTo(Print& p) const {
+  return p.printf("%u.%u.%u.%u", m_addr[0], m_addr[1], m_addr[2], m_addr[3]);
+}
+
+#endif // defined(__linux__)
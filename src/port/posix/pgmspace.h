@@ -0,0 +1,16 @@
+#ifndef ESP8266NDN_PORT_POSIX_PGMSPACE_H
+#define ESP8266NDN_PORT_POSIX_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Linux has a flat address space: program memory is ordinary memory.
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#endif // ESP8266NDN_PORT_POSIX_PGMSPACE_H
@@ -0,0 +1,167 @@
+#if defined(__linux__)
+
+#include "WiFiUdp.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+sockaddr_in
+makeSockaddr(IPAddress ip, uint16_t port) {
+  sockaddr_in sin{};
+  sin.sin_family = AF_INET;
+  sin.sin_addr.s_addr = static_cast<uint32_t>(ip);
+  sin.sin_port = htons(port);
+  return sin;
+}
+
+} // anonymous namespace
+
+bool
+WiFiUDP::open(uint16_t port, bool reuse) {
+  stop();
+  m_fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (m_fd < 0) {
+    return false;
+  }
+
+  int one = 1;
+  if (reuse) {
+    ::setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  }
+
+  sockaddr_in sin = makeSockaddr(IPAddress(), port);
+  if (::bind(m_fd, reinterpret_cast<const sockaddr*>(&sin), sizeof(sin)) != 0) {
+    stop();
+    return false;
+  }
+  return true;
+}
+
+uint8_t
+WiFiUDP::begin(uint16_t port) {
+  return open(port, false);
+}
+
+uint8_t
+WiFiUDP::beginMulticast(IPAddress interfaceAddr, IPAddress multicast, uint16_t port) {
+  if (!open(port, true)) {
+    return 0;
+  }
+
+  ip_mreq mreq{};
+  mreq.imr_multiaddr.s_addr = static_cast<uint32_t>(multicast);
+  mreq.imr_interface.s_addr = static_cast<uint32_t>(interfaceAddr);
+  if (::setsockopt(m_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+    stop();
+    return 0;
+  }
+
+  // do not receive our own multicast packets, same as lwIP
+  uint8_t loop = 0;
+  ::setsockopt(m_fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+  return 1;
+}
+
+void
+WiFiUDP::stop() {
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+  m_fd = -1;
+  m_rxLen = 0;
+}
+
+int
+WiFiUDP::parsePacket() {
+  if (m_fd < 0) {
+    return 0;
+  }
+  flush();
+
+  sockaddr_in sin{};
+  socklen_t sinLen = sizeof(sin);
+  ssize_t len = ::recvfrom(m_fd, nullptr, 0, MSG_PEEK | MSG_TRUNC | MSG_DONTWAIT,
+                           reinterpret_cast<sockaddr*>(&sin), &sinLen);
+  if (len <= 0) {
+    if (len == 0) {
+      // discard empty datagram
+      ::recv(m_fd, nullptr, 0, MSG_DONTWAIT);
+    }
+    return 0;
+  }
+
+  m_rxLen = len;
+  m_remoteIp = IPAddress(static_cast<uint32_t>(sin.sin_addr.s_addr));
+  m_remotePort = ntohs(sin.sin_port);
+  return m_rxLen;
+}
+
+int
+WiFiUDP::available() {
+  return m_rxLen;
+}
+
+int
+WiFiUDP::read(uint8_t* buffer, size_t len) {
+  if (m_rxLen == 0) {
+    return -1;
+  }
+  ssize_t n = ::recv(m_fd, buffer, len, MSG_DONTWAIT);
+  m_rxLen = 0;
+  return n < 0 ? -1 : std::min<ssize_t>(n, len);
+}
+
+void
+WiFiUDP::flush() {
+  if (m_rxLen > 0) {
+    ::recv(m_fd, nullptr, 0, MSG_DONTWAIT);
+    m_rxLen = 0;
+  }
+}
+
+int
+WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+  if (m_fd < 0) {
+    return 0;
+  }
+  m_txIp = ip;
+  m_txPort = port;
+  m_txBuf.clear();
+  return 1;
+}
+
+int
+WiFiUDP::beginPacketMulticast(IPAddress multicastAddress, uint16_t port,
+                              IPAddress interfaceAddress, int ttl) {
+  if (m_fd < 0) {
+    return 0;
+  }
+  in_addr ifaddr{};
+  ifaddr.s_addr = static_cast<uint32_t>(interfaceAddress);
+  uint8_t ttl8 = ttl;
+  if (::setsockopt(m_fd, IPPROTO_IP, IP_MULTICAST_IF, &ifaddr, sizeof(ifaddr)) != 0 ||
+      ::setsockopt(m_fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl8, sizeof(ttl8)) != 0) {
+    return 0;
+  }
+  return beginPacket(multicastAddress, port);
+}
+
+int
+WiFiUDP::endPacket() {
+  if (m_fd < 0) {
+    return 0;
+  }
+  sockaddr_in sin = makeSockaddr(m_txIp, m_txPort);
+  ssize_t n = ::sendto(m_fd, m_txBuf.data(), m_txBuf.size(), MSG_DONTWAIT,
+                       reinterpret_cast<const sockaddr*>(&sin), sizeof(sin));
+  bool ok = n >= 0 && static_cast<size_t>(n) == m_txBuf.size();
+  m_txBuf.clear();
+  return ok;
+}
+
+#endif // defined(__linux__)
@@ -0,0 +1,89 @@
+#ifndef ESP8266NDN_PORT_QUEUE_PTHREAD_HPP
+#define ESP8266NDN_PORT_QUEUE_PTHREAD_HPP
+
+#include "choose.h"
+
+#include <cstdlib>
+#include <pthread.h>
+#include <tuple>
+#include <type_traits>
+
+namespace esp8266ndn {
+namespace ndnph_port_pthread {
+
+/** @brief Generic thread-safe queue, implemented with a ring buffer and pthread mutex. */
+template<typename T, size_t capacity>
+class SafeQueue {
+public:
+  using Item = T;
+  static_assert(std::is_trivially_copyable<Item>::value, "");
+  static_assert(std::is_trivially_destructible<Item>::value, "");
+
+  SafeQueue() {
+    pthread_mutex_init(&m_mutex, nullptr);
+  }
+
+  ~SafeQueue() {
+    pthread_mutex_destroy(&m_mutex);
+  }
+
+  SafeQueue(const SafeQueue&) = delete;
+  SafeQueue& operator=(const SafeQueue&) = delete;
+
+  bool push(Item item) {
+    Lock lock(m_mutex);
+    if (m_size == capacity) {
+      return false;
+    }
+    m_items[(m_head + m_size) % capacity] = item;
+    ++m_size;
+    return true;
+  }
+
+  std::tuple<Item, bool> pop() {
+    Lock lock(m_mutex);
+    if (m_size == 0) {
+      return std::make_tuple(Item(), false);
+    }
+    Item item = m_items[m_head];
+    m_head = (m_head + 1) % capacity;
+    --m_size;
+    return std::make_tuple(std::move(item), true);
+  }
+
+private:
+  class Lock {
+  public:
+    explicit Lock(pthread_mutex_t& mutex)
+      : m_mutex(mutex) {
+      pthread_mutex_lock(&m_mutex);
+    }
+
+    ~Lock() {
+      pthread_mutex_unlock(&m_mutex);
+    }
+
+  private:
+    pthread_mutex_t& m_mutex;
+  };
+
+private:
+  pthread_mutex_t m_mutex;
+  Item m_items[capacity];
+  size_t m_head = 0;
+  size_t m_size = 0;
+};
+
+} // namespace ndnph_port_pthread
+} // namespace esp8266ndn
+
+#ifdef ESP8266NDN_PORT_QUEUE_PTHREAD
+namespace ndnph {
+namespace port {
+template<typename T, size_t capacity>
+using SafeQueue = esp8266ndn::ndnph_port_pthread::SafeQueue<T, capacity>;
+} // namespace port
+} // namespace ndnph
+#endif // ESP8266NDN_PORT_QUEUE_PTHREAD
+
+#endif // ESP8266NDN_PORT_QUEUE_PTHREAD_HPP
@@ -1,4 +1,5 @@
 #include "random.hpp"
+#include "chacha-drbg.hpp"
 
 #if defined(ARDUINO_ARCH_ESP8266)
 #include <Arduino.h>
@@ -10,13 +11,17 @@
 #include <nrf_soc.h>
 #elif defined(ARDUINO_ARCH_RP2040)
 #include <Arduino.h>
+#include <cstring>
+#elif defined(__linux__)
+#include <cerrno>
+#include <sys/random.h>
 #endif
 
 namespace esp8266ndn {
 namespace ndnph_port {
 
 bool
-RandomSource::generate(uint8_t* output, size_t count) {
+RandomSource::generateHardware(uint8_t* output, size_t count) {
 #if defined(ARDUINO_ARCH_ESP8266)
   for (size_t i = 0; i < count; ++i) {
     output[i] = ::secureRandom(0x100);
@@ -46,8 +51,27 @@ RandomSource::generate(uint8_t* output, size_t count) {
   }
   return true;
 #elif defined(ARDUINO_ARCH_RP2040)
-  for (size_t i = 0; i < count; ++i) {
-    output[i] = rp2040.hwrand32();
+  for (; count >= 4; count -= 4) {
+    uint32_t r = rp2040.hwrand32();
+    std::memcpy(output, &r, 4);
+    output += 4;
+  }
+  if (count > 0) {
+    uint32_t r = rp2040.hwrand32();
+    std::memcpy(output, &r, count);
+  }
+  return true;
+#elif defined(__linux__)
+  while (count > 0) {
+    ssize_t nRead = ::getrandom(output, count, 0);
+    if (nRead < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    output += nRead;
+    count -= nRead;
   }
   return true;
 #else
@@ -55,5 +79,15 @@ RandomSource::generate(uint8_t* output, size_t count) {
 #endif
 }
 
+bool
+RandomSource::generate(uint8_t* output, size_t count) {
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_RP2040)
+  static ChaChaDrbg drbg(generateHardware);
+  return drbg.generate(output, count);
+#else
+  return generateHardware(output, count);
+#endif
+}
+
 } // namespace ndnph_port
 } // namespace esp8266ndn
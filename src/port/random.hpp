@@ -8,16 +8,24 @@ namespace esp8266ndn {
 namespace ndnph_port {
 
 /**
- * @brief Hardware random bytes generator.
+ * @brief Random bytes generator.
  *
  * ESP8266/ESP32: WiFi or Bluetooth radio must be enabled.
  * nRF52: SoftDevice must be enabled.
+ * Linux: reads from getrandom(2).
+ *
+ * ESP8266 and RP2040 hardware sources deliver a few octets per call. On these platforms,
+ * generate() serves output from a ChaChaDrbg seeded by generateHardware(). It must be invoked
+ * from one thread only.
  */
 class RandomSource {
 public:
   RandomSource() = delete;
 
   static bool generate(uint8_t* output, size_t count);
+
+  /** @brief Read from hardware random source directly. */
+  static bool generateHardware(uint8_t* output, size_t count);
 };
 
 } // namespace ndnph_port
@@ -27,7 +27,11 @@ private:
   ::br_sha256_context m_ctx;
 };
 
-/** @brief HMAC-SHA256 algorithm, implemented with BearSSL. */
+/**
+ * @brief HMAC-SHA256 algorithm, implemented with BearSSL.
+ *
+ * br_hmac_key_context keeps the key midstates, so that each message starts from them.
+ */
 class HmacSha256 {
 public:
   explicit HmacSha256(const uint8_t* key, size_t keyLen) {
@@ -27,7 +27,11 @@ private:
   ::Sha256 m_sha;
 };
 
-/** @brief HMAC-SHA256 algorithm, implemented with Cryptosuite. */
+/**
+ * @brief HMAC-SHA256 algorithm, implemented with Cryptosuite.
+ *
+ * Inner and outer key pads are hashed once in the constructor.
+ */
 class HmacSha256 {
 public:
   explicit HmacSha256(const uint8_t* key, size_t keyLen) {
@@ -6,11 +6,34 @@
 
 namespace esp8266ndn {
 
-BleServerTransportBase::BleServerTransportBase(size_t mtu)
-  : DynamicRxQueueMixin(mtu) {}
+BleServerTransportBase::BleServerTransportBase(size_t maxFrameLen, size_t nConnections)
+  : DynamicRxQueueMixin(MaxPacketLen + LpReassembler::ReassemblyHeadroom)
+  , m_fragmenter(maxFrameLen)
+  , m_reassembler(nConnections, MaxPacketLen) {}
 
 void
-BleServerTransportBase::handleReceive(const uint8_t* pkt, size_t pktLen, uint64_t endpointId) {
+BleServerTransportBase::handleReceive(const uint8_t* frame, size_t frameLen,
+                                      uint64_t endpointId) {
+  const uint8_t* pkt = nullptr;
+  size_t pktLen = 0;
+  switch (m_reassembler.process(endpointId, frame, frameLen, pkt, pktLen)) {
+    case LpReassembler::Result::Pass:
+      deliver(frame, frameLen, endpointId);
+      break;
+    case LpReassembler::Result::Complete:
+      deliver(pkt, pktLen, endpointId);
+      break;
+    case LpReassembler::Result::Accepted:
+      break;
+    case LpReassembler::Result::Dropped:
+      LOG(F("drop: bad or out-of-order fragment, endpoint=")
+          << _DEC(static_cast<unsigned long>(endpointId)));
+      break;
+  }
+}
+
+void
+BleServerTransportBase::deliver(const uint8_t* pkt, size_t pktLen, uint64_t endpointId) {
   auto r = receiving();
   if (!r) {
     LOG(F("drop: no RX buffer"));
@@ -31,4 +54,28 @@ BleServerTransportBase::doLoop() {
   loopRxQueue();
 }
 
+#if defined(ARDUINO_ARCH_NRF52) &&                                                                 \
+  !(defined(CONFIG_BT_NIMBLE_ROLE_PERIPHERAL) && CONFIG_BT_NIMBLE_ROLE_PERIPHERAL)
+
+BleServerTransport* BleServerTransport::s_instance = nullptr;
+
+void
+BleServerTransport::handleBleEvent(ble_evt_t* evt) {
+  BleServerTransport* self = s_instance;
+  if (self == nullptr) {
+    return;
+  }
+
+  switch (evt->header.evt_id) {
+    case BLE_GAP_EVT_CONNECTED:
+      self->m_txQueue.setCredits(HvnTxQueueSize);
+      break;
+    case BLE_GATTS_EVT_HVN_TX_COMPLETE:
+      self->m_txQueue.complete(evt->evt.gatts_evt.params.hvn_tx_complete.count);
+      break;
+  }
+}
+
+#endif // ARDUINO_ARCH_NRF52
+
 } // namespace esp8266ndn
@@ -2,7 +2,11 @@
 #define ESP8266NDN_BLE_SERVER_TRANSPORT_HPP
 
 #include "../port/port.hpp"
+#include "ble-tx-queue.hpp"
 #include "ble-uuid.hpp"
+#include "lp-fragmentation.hpp"
+
+#include <algorithm>
 
 #if defined(ARDUINO_ARCH_ESP32) && __has_include(<NimBLEDevice.h>)
 #include <NimBLEDevice.h>
@@ -12,41 +16,95 @@
 
 namespace esp8266ndn {
 
+/**
+ * @brief Common part of BLE server transports.
+ *
+ * Each connection has its own ATT MTU, negotiated with the central. An outgoing packet that
+ * exceeds the ATT MTU of its connection is split into NDNLPv2 fragments that fit, and incoming
+ * fragments are reassembled per connection in a preallocated pool. Therefore, the Face does not
+ * need a fragmenter or reassembler, and sees packets up to getMtu() octets.
+ *
+ * Each received packet is tagged with EndpointId = connection handle + 1, and a packet sent to
+ * that EndpointId is notified to that connection only. A packet sent to EndpointId 0 is notified
+ * to every connection.
+ */
 class BleServerTransportBase
   : public virtual ndnph::Transport
   , public ndnph::transport::DynamicRxQueueMixin {
+public:
+  /** @brief Return maximum network layer packet length. */
+  static size_t getMtu() {
+    return MaxPacketLen;
+  }
+
+  /** @brief Read reassembler counters. */
+  LpReassembler::Counters readReassemblerCounters() const {
+    return m_reassembler.readCounters();
+  }
+
+public:
+  enum {
+    MaxPacketLen = 1500,
+  };
+
 protected:
-  explicit BleServerTransportBase(size_t mtu);
+  /**
+   * @param maxFrameLen maximum notification payload length, i.e. maximum ATT MTU minus 3.
+   * @param nConnections maximum number of concurrent connections.
+   */
+  explicit BleServerTransportBase(size_t maxFrameLen, size_t nConnections);
 
-  void handleReceive(const uint8_t* pkt, size_t pktLen, uint64_t endpointId);
+  /** @brief Process a frame received from a connection, reassembling if necessary. */
+  void handleReceive(const uint8_t* frame, size_t frameLen, uint64_t endpointId);
 
-private:
   void doLoop() override;
+
+  /** @brief Convert connection handle to EndpointId, reserving 0 for all connections. */
+  static uint64_t toEndpointId(uint16_t connHandle) {
+    return static_cast<uint64_t>(connHandle) + 1;
+  }
+
+  /** @brief Convert nonzero EndpointId to connection handle. */
+  static uint16_t toConnHandle(uint64_t endpointId) {
+    return static_cast<uint16_t>(endpointId - 1);
+  }
+
+private:
+  void deliver(const uint8_t* pkt, size_t pktLen, uint64_t endpointId);
+
+protected:
+  LpFragmenter m_fragmenter;
+
+private:
+  LpReassembler m_reassembler;
 };
 
 #if defined(CONFIG_BT_NIMBLE_ROLE_PERIPHERAL) && CONFIG_BT_NIMBLE_ROLE_PERIPHERAL
 
-/** @brief A transport that acts as a BLE server/peripheral. */
+/**
+ * @brief A transport that acts as a BLE server/peripheral.
+ *
+ * Up to @c CONFIG_BT_NIMBLE_MAX_CONNECTIONS centrals may be connected at the same time.
+ *
+ * Incoming writes are delivered into the RX queue from the buffer that NimBLE flattened out of
+ * the ATT request, bypassing the characteristic's stored value. Notifications are sent from the
+ * caller's buffer without updating the stored value.
+ */
 class BleServerTransport : public BleServerTransportBase {
 public:
-  static size_t getMtu() {
-    return 512;
-  }
-
   BleServerTransport()
-    : BleServerTransportBase(getMtu())
-    , m_csCallbackHandler(*this) {}
+    : BleServerTransportBase(MaxAttMtu - 3, CONFIG_BT_NIMBLE_MAX_CONNECTIONS) {}
 
   /** @brief Initialize BLE device, service, and advertisement. */
   bool begin(const char* deviceName) {
     NimBLEDevice::init(deviceName);
-    NimBLEDevice::setMTU(517);
+    NimBLEDevice::setMTU(MaxAttMtu);
 
     m_server = NimBLEDevice::createServer();
+    m_server->setCallbacks(&m_serverCallbackHandler, false);
     m_svc = m_server->createService(makeUuid(BLE_UUID_SVC));
-    m_cs = m_svc->createCharacteristic(makeUuid(BLE_UUID_CS),
-                                       NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::NOTIFY);
-    m_cs->setCallbacks(&m_csCallbackHandler);
+    m_cs = new CsCharacteristic(*this); // owned by service
+    m_svc->addCharacteristic(m_cs);
     m_sc = m_svc->createCharacteristic(makeUuid(BLE_UUID_SC),
                                        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY);
     m_svc->start();
@@ -76,33 +134,84 @@ private:
     if (m_sc == nullptr) {
       return false;
     }
-    m_sc->setValue(const_cast<uint8_t*>(pkt), pktLen);
-    m_sc->notify();
+    if (endpointId != 0) {
+      return sendTo(toConnHandle(endpointId), pkt, pktLen);
+    }
+
+    bool ok = false;
+    for (uint16_t connHandle : m_server->getPeerDevices()) {
+      ok = sendTo(connHandle, pkt, pktLen) || ok;
+    }
+    return ok;
+  }
+
+  /** @brief Notify a packet to a connection, fragmented according to its ATT MTU. */
+  bool sendTo(uint16_t connHandle, const uint8_t* pkt, size_t pktLen) {
+    uint16_t attMtu = m_server->getPeerMTU(connHandle);
+    if (attMtu <= 3 || m_fragmenter.begin(pkt, pktLen, attMtu - 3) == 0) {
+      return false;
+    }
+    const uint8_t* frame = nullptr;
+    bool isFirst = true;
+    while (size_t frameLen = m_fragmenter.next(frame)) {
+      // once the first fragment is out, the receiver discards the packet unless all others follow,
+      // so that a notification failing due to mbuf shortage is retried after NimBLE frees some
+      for (int nTries = isFirst ? 1 : MaxNotifyTries; !m_sc->notify(frame, frameLen, connHandle);) {
+        if (--nTries == 0) {
+          return false;
+        }
+        delay(1);
+      }
+      isFirst = false;
+    }
     return true;
   }
 
 private:
-  class CsCallbacks : public NimBLECharacteristicCallbacks {
-  public:
-    explicit CsCallbacks(BleServerTransport& transport)
-      : m_transport(transport) {}
+  enum {
+    MaxAttMtu = 517,
+    /** @brief Notification attempts for each non-first fragment. */
+    MaxNotifyTries = 20,
+  };
 
-    void onWrite(NimBLECharacteristic* chr, NimBLEConnInfo&) final {
-      if (chr != m_transport.m_cs) {
-        return;
+private:
+  class ServerCallbacks : public NimBLEServerCallbacks {
+  public:
+    void onConnect(NimBLEServer* server, NimBLEConnInfo&) final {
+      // advertising stops upon connection; resume it to accept more centrals
+      if (server->getConnectedCount() < CONFIG_BT_NIMBLE_MAX_CONNECTIONS) {
+        NimBLEDevice::startAdvertising();
       }
-      auto value = chr->getValue();
-      m_transport.handleReceive(reinterpret_cast<const uint8_t*>(value.c_str()), value.length(), 0);
+    }
+  };
+  ServerCallbacks m_serverCallbackHandler;
+
+  /**
+   * @brief Client-to-server characteristic.
+   *
+   * NimBLEServer invokes writeEvent() with the ATT request already flattened into a buffer.
+   * Overriding it avoids the default behavior of copying the buffer into the stored value, and
+   * then copying the stored value again in getValue().
+   */
+  class CsCharacteristic : public NimBLECharacteristic {
+  public:
+    explicit CsCharacteristic(BleServerTransport& transport)
+      : NimBLECharacteristic(makeUuid(BLE_UUID_CS),
+                             NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::NOTIFY)
+      , m_transport(transport) {}
+
+  private:
+    void writeEvent(const uint8_t* val, uint16_t len, NimBLEConnInfo& connInfo) override {
+      m_transport.handleReceive(val, len, toEndpointId(connInfo.getConnHandle()));
     }
 
   private:
     BleServerTransport& m_transport;
   };
-  CsCallbacks m_csCallbackHandler;
 
   NimBLEServer* m_server = nullptr;
   NimBLEService* m_svc = nullptr;
-  NimBLECharacteristic* m_cs = nullptr;
+  CsCharacteristic* m_cs = nullptr;
   NimBLECharacteristic* m_sc = nullptr;
 };
 
@@ -111,29 +220,34 @@ private:
 /**
  * @brief A transport that acts as a BLE server/peripheral.
  *
- * @bug Rapidly transmitting multiple packets can cause significant packet loss due to lack of
- *      queuing. Such loss severely affects fragmentation.
+ * Outgoing fragments are queued, and passed to the SoftDevice only when its HVN TX queue has room.
+ * A packet with more fragments than free queue slots is copied, and its remaining fragments are
+ * queued as the SoftDevice completes notifications. While such a packet is pending, send() returns
+ * false, so that the sender can retry later.
  */
 class BleServerTransport
   : public BleServerTransportBase
   , public ::BLEService {
 public:
-  static size_t getMtu() {
-    return BLE_GATT_ATT_MTU_MAX - 3;
-  }
-
   BleServerTransport()
-    : BleServerTransportBase(getMtu())
+    : BleServerTransportBase(BLE_GATT_ATT_MTU_MAX - 3, 1)
     , ::BLEService(BLE_UUID_SVC)
     , m_cs(BLE_UUID_CS)
-    , m_sc(BLE_UUID_SC) {}
+    , m_sc(BLE_UUID_SC)
+    , m_trainPkt(new uint8_t[MaxPacketLen]) {
+    m_txQueue.resize(TxQueueCapacity, BLE_GATT_ATT_MTU_MAX - 3);
+  }
 
-  /** @brief Initialize BLE device, service, and advertisement. */
+  /**
+   * @brief Initialize BLE device, service, and advertisement.
+   *
+   * This installs handleBleEvent() as Bluefruit event callback.
+   */
   bool begin(const char* deviceName) {
-    Bluefruit.configPrphConn(BLE_GATT_ATT_MTU_MAX, BLE_GAP_EVENT_LENGTH_DEFAULT,
-                             BLE_GATTS_HVN_TX_QUEUE_SIZE_DEFAULT,
+    Bluefruit.configPrphConn(BLE_GATT_ATT_MTU_MAX, BLE_GAP_EVENT_LENGTH_DEFAULT, HvnTxQueueSize,
                              BLE_GATTC_WRITE_CMD_TX_QUEUE_SIZE_DEFAULT);
     VERIFY(Bluefruit.begin(1, 0));
+    Bluefruit.setEventCallback(handleBleEvent);
     Bluefruit.setName(deviceName);
     Bluefruit.setTxPower(4);
 
@@ -154,6 +268,7 @@ public:
   /** @brief Initialize BLE service only. */
   err_t begin() final {
     VERIFY_STATUS(this->BLEService::begin());
+    s_instance = this;
 
     uint16_t mtu = Bluefruit.getMaxMtu(CONN_CFG_PERIPHERAL);
     m_cs.setProperties(CHR_PROPS_WRITE | CHR_PROPS_NOTIFY);
@@ -183,24 +298,108 @@ public:
     return String(addr) + " (addr-type=" + static_cast<int>(addrType) + ")";
   }
 
+  /**
+   * @brief Handle BLE events for TX flow control.
+   *
+   * If the application installs its own Bluefruit event callback, or initializes the service
+   * with begin() only, it must pass every event to this function.
+   */
+  static void handleBleEvent(ble_evt_t* evt);
+
+  /** @brief Return number of packets waiting for HVN TX queue. */
+  size_t getTxQueueDepth() const {
+    return m_txQueue.size();
+  }
+
+  /** @brief Read TX queue counters. */
+  BleTxQueue::Counters readTxCounters() const {
+    return m_txQueue.readCounters();
+  }
+
+public:
+  enum {
+    /** @brief SoftDevice HVN TX queue size, i.e. notifications in flight. */
+    HvnTxQueueSize = 4,
+    /** @brief Number of fragments queued in addition to HVN TX queue. */
+    TxQueueCapacity = 8,
+  };
+
 private:
   bool doIsUp() const final {
     return Bluefruit.connected() > 0;
   }
 
+  void doLoop() final {
+    m_txQueue.drain(m_sc);
+    continueTrain();
+    m_txQueue.drain(m_sc);
+    BleServerTransportBase::doLoop();
+  }
+
   bool doSend(const uint8_t* pkt, size_t pktLen, uint64_t endpointId) final {
-    m_sc.write(pkt, pktLen);
-    return m_sc.notify(pkt, pktLen);
+    if (endpointId != 0) {
+      return sendTo(toConnHandle(endpointId), pkt, pktLen);
+    }
+
+    bool ok = false;
+    for (uint16_t connHandle = 0; connHandle < BLE_MAX_CONNECTION; ++connHandle) {
+      if (Bluefruit.connected(connHandle)) {
+        ok = sendTo(connHandle, pkt, pktLen) || ok;
+      }
+    }
+    return ok;
+  }
+
+  /** @brief Enqueue a packet for a connection, fragmented according to its ATT MTU. */
+  bool sendTo(uint16_t connHandle, const uint8_t* pkt, size_t pktLen) {
+    BLEConnection* conn = Bluefruit.Connection(connHandle);
+    if (conn == nullptr || pktLen > MaxPacketLen) {
+      return false;
+    }
+    continueTrain();
+    if (m_trainLeft > 0) {
+      return false;
+    }
+
+    size_t nFrames = m_fragmenter.begin(pkt, pktLen, conn->getMtu() - 3);
+    if (nFrames == 0) {
+      return false;
+    }
+    if (nFrames > m_txQueue.available()) {
+      // caller's buffer is not retained, so that remaining fragments are cut from a copy
+      std::copy_n(pkt, pktLen, m_trainPkt.get());
+      m_fragmenter.begin(m_trainPkt.get(), pktLen, conn->getMtu() - 3);
+    }
+    m_trainConn = connHandle;
+    m_trainLeft = nFrames;
+    continueTrain();
+    m_txQueue.drain(m_sc);
+    return true;
+  }
+
+  /** @brief Enqueue fragments of the pending packet while queue slots are available. */
+  void continueTrain() {
+    const uint8_t* frame = nullptr;
+    for (; m_trainLeft > 0 && m_txQueue.available() > 0; --m_trainLeft) {
+      size_t frameLen = m_fragmenter.next(frame);
+      m_txQueue.push(frame, frameLen, m_trainConn);
+    }
   }
 
   static void handleCsWrite(uint16_t connHdl, ::BLECharacteristic* chr, uint8_t* pkt,
                             uint16_t pktLen) {
     BleServerTransport& self = static_cast<BleServerTransport&>(chr->parentService());
-    self.handleReceive(pkt, pktLen, connHdl);
+    self.handleReceive(pkt, pktLen, toEndpointId(connHdl));
   }
 
+  static BleServerTransport* s_instance;
+
   ::BLECharacteristic m_cs;
   ::BLECharacteristic m_sc;
+  BleTxQueue m_txQueue;
+  std::unique_ptr<uint8_t[]> m_trainPkt; ///< copy of packet whose fragments are partially queued
+  size_t m_trainLeft = 0;                ///< fragments of pending packet not yet queued
+  uint16_t m_trainConn = 0;
 };
 
 #endif // ARDUINO_ARCH_*
@@ -0,0 +1,54 @@
+#include "ble-tx-queue.hpp"
+
+#include <cstring>
+
+namespace esp8266ndn {
+
+bool
+BleTxQueue::resize(size_t capacity, size_t mtu) {
+  if (capacity == 0 || mtu > UINT16_MAX) {
+    return false;
+  }
+
+  m_buf.reset(new uint8_t[capacity * mtu]);
+  m_items.reset(new Item[capacity]);
+  for (size_t i = 0; i < capacity; ++i) {
+    m_items[i].pkt = &m_buf[i * mtu];
+  }
+  m_capacity = capacity;
+  m_mtu = mtu;
+  m_head = 0;
+  m_size = 0;
+  return true;
+}
+
+bool
+BleTxQueue::push(const uint8_t* pkt, size_t pktLen, uint16_t connHandle) {
+  if (pktLen > m_mtu) {
+    return false;
+  }
+  if (m_size == m_capacity) {
+    ++m_cnt.nFull;
+    return false;
+  }
+
+  Item& item = m_items[(m_head + m_size) % m_capacity];
+  std::memcpy(item.pkt, pkt, pktLen);
+  item.pktLen = pktLen;
+  item.connHandle = connHandle;
+  ++m_size;
+  return true;
+}
+
+bool
+BleTxQueue::takeCredit() {
+  uint16_t n = m_credits.load();
+  while (n > 0) {
+    if (m_credits.compare_exchange_weak(n, n - 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace esp8266ndn
@@ -0,0 +1,123 @@
+#ifndef ESP8266NDN_TRANSPORT_BLE_TX_QUEUE_HPP
+#define ESP8266NDN_TRANSPORT_BLE_TX_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace esp8266ndn {
+
+/**
+ * @brief Bounded queue of outgoing BLE notifications with credit-based flow control.
+ *
+ * Each credit represents a free slot in the BLE stack's notification TX queue. A notification is
+ * passed to the BLE stack only if a credit is available, and the credit is returned when the BLE
+ * stack reports TX completion. Thus, the BLE stack never has to drop or block on a notification.
+ *
+ * push() and drain() must be invoked from the same thread. setCredits() and complete() may be
+ * invoked from the BLE event handler.
+ */
+class BleTxQueue {
+public:
+  struct Counters {
+    /** @brief Notifications accepted by the BLE stack. */
+    uint32_t nSent = 0;
+    /** @brief Packets rejected because the queue is full. */
+    uint32_t nFull = 0;
+    /** @brief Notifications rejected by the BLE stack, such as after disconnection. */
+    uint32_t nErrors = 0;
+  };
+
+  size_t capacity() const {
+    return m_capacity;
+  }
+
+  /** @brief Return number of queued packets. */
+  size_t size() const {
+    return m_size;
+  }
+
+  /** @brief Return number of free slots. */
+  size_t available() const {
+    return m_capacity - m_size;
+  }
+
+  /**
+   * @brief Change capacity.
+   * @param capacity number of slots.
+   * @param mtu maximum packet length.
+   * @return whether success.
+   *
+   * Queued packets are discarded.
+   */
+  bool resize(size_t capacity, size_t mtu);
+
+  /**
+   * @brief Append a packet.
+   * @return whether success; false if the queue is full or the packet exceeds MTU.
+   */
+  bool push(const uint8_t* pkt, size_t pktLen, uint16_t connHandle);
+
+  /** @brief Set available credits, typically the HVN TX queue size upon connection. */
+  void setCredits(uint16_t n) {
+    m_credits.store(n);
+  }
+
+  /** @brief Return credits upon TX completion. */
+  void complete(uint16_t n) {
+    m_credits.fetch_add(n);
+  }
+
+  /**
+   * @brief Pass queued packets to the BLE stack, as long as credits are available.
+   * @tparam Chr characteristic type with
+   *             <tt>bool notify(uint16_t connHandle, const void* data, uint16_t len)</tt> .
+   * @return number of notifications accepted by the BLE stack.
+   */
+  template<typename Chr>
+  size_t drain(Chr& chr) {
+    size_t nSent = 0;
+    while (m_size > 0 && takeCredit()) {
+      const Item& item = m_items[m_head];
+      if (chr.notify(item.connHandle, item.pkt, item.pktLen)) {
+        ++nSent;
+      } else {
+        complete(1);
+        ++m_cnt.nErrors;
+      }
+      m_head = (m_head + 1) % m_capacity;
+      --m_size;
+    }
+    m_cnt.nSent += nSent;
+    return nSent;
+  }
+
+  /** @brief Read counters. */
+  Counters readCounters() const {
+    return m_cnt;
+  }
+
+private:
+  struct Item {
+    uint8_t* pkt;
+    uint16_t pktLen;
+    uint16_t connHandle;
+  };
+
+  bool takeCredit();
+
+private:
+  std::unique_ptr<uint8_t[]> m_buf;
+  std::unique_ptr<Item[]> m_items;
+  size_t m_capacity = 0;
+  size_t m_mtu = 0;
+  size_t m_head = 0;
+  size_t m_size = 0;
+  std::atomic<uint16_t> m_credits{0};
+  Counters m_cnt;
+};
+
+} // namespace esp8266ndn
+
+#endif // ESP8266NDN_TRANSPORT_BLE_TX_QUEUE_HPP
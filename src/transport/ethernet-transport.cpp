@@ -2,6 +2,8 @@
 
 #include "ethernet-transport.hpp"
 #include "../core/logger.hpp"
+#include "lwip-lock.hpp"
+#include "packet-filter.hpp"
 
 #include <IPAddress.h>
 #include <lwip/init.h>
@@ -26,15 +28,32 @@ union EndpointId {
 
 static_assert(sizeof(EndpointId) == sizeof(uint64_t), "");
 
-} // anonymous namespace
+/** @brief Minimum Ethernet payload length; shorter packets are zero-padded. */
+constexpr size_t MinPayload = 46;
+
+/** @brief Determine EndpointId from source address of a received frame. */
+inline uint64_t
+endpointOf(const eth_hdr* eth) {
+  EndpointId endpoint{};
+  memcpy(endpoint.addr, &eth->src, 6);
+  endpoint.isMulticast = 0x01 & (*reinterpret_cast<const uint8_t*>(&eth->dest));
+  return endpoint.id;
+}
 
-static EthernetTransport* g_ethTransport = nullptr;
+} // anonymous namespace
 
 class EthernetTransport::Impl {
 public:
-  explicit Impl(netif* nif)
-    : nif(nif)
-    , oldInput(nif->input) {
+  /** @pre findSlot(nif) == nullptr && findSlot(nullptr) != nullptr */
+  explicit Impl(EthernetTransport& transport, netif* nif)
+    : transport(transport)
+    , nif(nif)
+    , oldInput(nif->input)
+    , zeroCopyRx(transport.m_zeroCopyRx)
+    , rxFilter(transport.m_rxFilter)
+    , cnt(transport.m_cnt) {
+    detail::LwipLock lock;
+    *findSlot(nullptr) = this;
 #if defined(ARDUINO_ARCH_ESP32)
     nif->input = EthernetTransport::Impl::input;
 #elif defined(HAS_PHY_CAPTURE) && HAS_PHY_CAPTURE
@@ -43,51 +62,111 @@ public:
   }
 
   ~Impl() {
+    {
+      detail::LwipLock lock;
 #if defined(ARDUINO_ARCH_ESP32)
-    nif->input = this->oldInput;
-#elif defined(HAS_PHY_CAPTURE) && HAS_PHY_CAPTURE
-    ::phy_capture = nullptr;
+      nif->input = this->oldInput;
+#endif
+      *findSlot(nif) = nullptr;
+#if defined(HAS_PHY_CAPTURE) && HAS_PHY_CAPTURE
+      if (std::all_of(std::begin(table), std::end(table),
+                      [](const Impl* impl) { return impl == nullptr; })) {
+        ::phy_capture = nullptr;
+      }
+#endif
+    }
+
+#if defined(ARDUINO_ARCH_ESP32)
+    while (pbuf* p = popRetained()) {
+      detail::LwipLock lock;
+      pbuf_free(p);
+    }
 #endif
   }
 
+  /**
+   * @brief Find a dispatch table slot.
+   * @param nif netif of an active instance, or nullptr to find an empty slot.
+   * @return pointer to the slot, or nullptr if not found.
+   *
+   * The table has @c MaxInstances slots, so that the lookup cost is bounded.
+   */
+  static Impl** findSlot(const netif* nif) {
+    for (Impl*& impl : table) {
+      if (nif == nullptr ? impl == nullptr : (impl != nullptr && impl->nif == nif)) {
+        return &impl;
+      }
+    }
+    return nullptr;
+  }
+
 #if defined(ARDUINO_ARCH_ESP32)
   static err_t input(pbuf* p, netif* inp) {
-    if (g_ethTransport == nullptr) {
+    Impl** slot = findSlot(inp);
+    if (slot == nullptr) {
       LOG(F("inactive"));
       pbuf_free(p);
       return ERR_OK;
     }
-    Impl& self = *g_ethTransport->m_impl;
+    Impl& self = **slot;
 
     const eth_hdr* eth = reinterpret_cast<const eth_hdr*>(p->payload);
-    if (self.nif != inp || p->len < sizeof(eth_hdr) || eth->type != NDN_ETHERTYPE_BE) {
+    if (p->len < sizeof(eth_hdr) || eth->type != NDN_ETHERTYPE_BE) {
       return self.oldInput(p, inp);
     }
 
+    if (!self.filter(reinterpret_cast<const uint8_t*>(p->payload), p->len)) {
+      pbuf_free(p);
+      return ERR_OK;
+    }
+
     if (p->next != nullptr) {
-      LOG(F("drop: chained packet"));
+      self.receiveChained(p);
+    } else if (self.zeroCopyRx && self.retained.push(p)) {
+      // input function owns the pbuf once it returns ERR_OK, so that no extra reference is needed
+      return ERR_OK;
     } else {
-      self.receive(reinterpret_cast<const uint8_t*>(p->payload), p->tot_len);
+      // when too many frames are retained, copy instead, so that driver RX buffers are released
+      self.copyFrame(reinterpret_cast<const uint8_t*>(p->payload), p->tot_len);
     }
     pbuf_free(p);
     return ERR_OK;
   }
+
+  /** @brief Reassemble a chained frame into RX buffer with a single copy. */
+  void receiveChained(const pbuf* p) {
+    auto r = transport.receiving();
+    size_t pktLen = p->tot_len - sizeof(eth_hdr);
+    if (!r || pktLen > r.bufLen() ||
+        pbuf_copy_partial(p, r.buf(), pktLen, sizeof(eth_hdr)) != pktLen) {
+      LOG(F("drop: no RX buffer for chained packet, size=") << _DEC(p->tot_len));
+      ++cnt.nRxChainedDropped;
+      return;
+    }
+
+    ++cnt.nRxChained;
+    r(pktLen, endpointOf(reinterpret_cast<const eth_hdr*>(p->payload)));
+  }
+
+  /** @brief Retrieve a retained frame; caller must free it. */
+  pbuf* popRetained() {
+    pbuf* p = nullptr;
+    bool ok = false;
+    std::tie(p, ok) = retained.pop();
+    return ok ? p : nullptr;
+  }
 #elif defined(HAS_PHY_CAPTURE) && HAS_PHY_CAPTURE
   static void capture(int ifindex, const char* payload, size_t size, int out, int success) {
     if (out != 0 || success != 1) {
       return;
     }
 
-    if (g_ethTransport == nullptr) {
-      LOG(F("inactive"));
-      return;
-    }
-    Impl& self = *g_ethTransport->m_impl;
-    if (ifindex != static_cast<int>(self.nif->num)) {
-      return;
+    for (Impl* self : table) {
+      if (self != nullptr && static_cast<int>(self->nif->num) == ifindex) {
+        self->receive(reinterpret_cast<const uint8_t*>(payload), size);
+        return;
+      }
     }
-
-    self.receive(reinterpret_cast<const uint8_t*>(payload), size);
   }
 #endif
 
@@ -97,7 +176,15 @@ public:
       return;
     }
 
-    auto r = g_ethTransport->receiving();
+    if (!filter(payload, size)) {
+      return;
+    }
+    copyFrame(payload, size);
+  }
+
+  /** @brief Copy an accepted NDN frame into RX buffer. */
+  void copyFrame(const uint8_t* payload, size_t size) {
+    auto r = transport.receiving();
     if (!r) {
       LOG(F("drop: no RX buffer"));
       return;
@@ -108,18 +195,108 @@ public:
       return;
     }
 
-    EndpointId endpoint{};
-    memcpy(endpoint.addr, &eth->src, 6);
-    endpoint.isMulticast = 0x01 & (*reinterpret_cast<const uint8_t*>(&eth->dest));
-
     size_t pktLen = size - sizeof(eth_hdr);
     memcpy(r.buf(), payload + sizeof(eth_hdr), pktLen);
-    r(pktLen, endpoint.id);
+    r(pktLen, endpointOf(reinterpret_cast<const eth_hdr*>(payload)));
+  }
+
+  /**
+   * @brief Apply RX filter on an NDN frame.
+   * @param size available length, which may be shorter than the frame.
+   * @return whether the frame is accepted.
+   */
+  bool filter(const uint8_t* frame, size_t size) {
+    if (rxFilter != nullptr &&
+        !rxFilter->accept(frame + sizeof(eth_hdr), size - sizeof(eth_hdr))) {
+      ++cnt.nRxFiltered;
+      return false;
+    }
+    ++cnt.nRxAccepted;
+    return true;
   }
 
 public:
+  static Impl* table[MaxInstances];
+
+  EthernetTransport& transport;
   netif* nif = nullptr;
   netif_input_fn oldInput = nullptr;
+  bool zeroCopyRx = false;
+  const PacketFilter* rxFilter = nullptr;
+  Counters& cnt;
+#if defined(ARDUINO_ARCH_ESP32)
+  ndnph::port::SafeQueue<pbuf*, ZeroCopyRxCapacity> retained;
+#endif
+};
+
+EthernetTransport::Impl* EthernetTransport::Impl::table[MaxInstances] = {};
+
+/** @brief Preallocated TX frames. */
+class EthernetTransport::TxPool {
+public:
+  explicit TxPool(size_t capacity)
+    : m_frames(new Frame[capacity]) {
+    detail::LwipLock lock;
+    for (; m_capacity < capacity; ++m_capacity) {
+      Frame& f = m_frames[m_capacity];
+      f.p = pbuf_alloc(PBUF_RAW_TX, FrameLen, PBUF_RAM);
+      if (f.p == nullptr) {
+        break;
+      }
+      f.base = reinterpret_cast<uint8_t*>(f.p->payload);
+    }
+  }
+
+  ~TxPool() {
+    detail::LwipLock lock;
+    for (size_t i = 0; i < m_capacity; ++i) {
+      pbuf_free(m_frames[i].p);
+    }
+  }
+
+  size_t capacity() const {
+    return m_capacity;
+  }
+
+  /** @brief Take an idle frame, i.e. not being prepared and not referenced by the driver. */
+  bool alloc(TxFrame& frame) {
+    detail::LwipLock lock;
+    for (size_t k = 0; k < m_capacity; ++k) {
+      size_t i = (m_next + k) % m_capacity;
+      Frame& f = m_frames[i];
+      if (f.busy || f.p->ref != 1) {
+        continue;
+      }
+
+      // restore headroom hidden by previous transmission; the frame end never moves
+      pbuf_add_header(f.p, static_cast<uint8_t*>(f.p->payload) - f.base);
+      f.busy = true;
+      m_next = i + 1;
+
+      frame.p = f.p;
+      frame.room = f.base + sizeof(eth_hdr);
+      frame.roomLen = MaxPayload;
+      frame.poolIndex = i;
+      return true;
+    }
+    return false;
+  }
+
+  void release(int index) {
+    m_frames[index].busy = false;
+  }
+
+private:
+  static constexpr uint16_t FrameLen = sizeof(eth_hdr) + MaxPayload;
+
+  struct Frame {
+    pbuf* p = nullptr;
+    uint8_t* base = nullptr;
+    bool busy = false;
+  };
+  std::unique_ptr<Frame[]> m_frames;
+  size_t m_capacity = 0;
+  size_t m_next = 0;
 };
 
 void
@@ -167,13 +344,20 @@ EthernetTransport::begin() {
 
 bool
 EthernetTransport::begin(netif* nif) {
-  if (g_ethTransport != nullptr) {
-    LOG(F("an instance is active"));
+  if (m_impl != nullptr) {
+    LOG(F("already enabled"));
+    return false;
+  }
+  if (Impl::findSlot(nif) != nullptr) {
+    LOG(F("netif ") << nif->name[0] << nif->name[1] << nif->num << F(" is in use"));
+    return false;
+  }
+  if (Impl::findSlot(nullptr) == nullptr) {
+    LOG(F("too many instances"));
     return false;
   }
 
-  g_ethTransport = this;
-  m_impl.reset(new Impl(nif));
+  m_impl.reset(new Impl(*this, nif));
   LOG(F("enabled on ") << nif->name[0] << nif->name[1] << nif->num);
   return true;
 }
@@ -184,10 +368,37 @@ EthernetTransport::end() {
     return;
   }
   m_impl.reset();
-  g_ethTransport = nullptr;
   LOG(F("disabled"));
 }
 
+bool
+EthernetTransport::setZeroCopyRx(bool enable) {
+  if (m_impl != nullptr) {
+    LOG(F("cannot change RX mode while active"));
+    return false;
+  }
+#if defined(ARDUINO_ARCH_ESP32)
+  m_zeroCopyRx = enable;
+  return true;
+#else
+  if (enable) {
+    LOG(F("zero-copy RX requires ESP32"));
+    return false;
+  }
+  return true;
+#endif
+}
+
+bool
+EthernetTransport::setRxFilter(const PacketFilter* filter) {
+  if (m_impl != nullptr) {
+    LOG(F("cannot change RX filter while active"));
+    return false;
+  }
+  m_rxFilter = filter;
+  return true;
+}
+
 bool
 EthernetTransport::doIsUp() const {
   return m_impl != nullptr;
@@ -195,24 +406,96 @@ EthernetTransport::doIsUp() const {
 
 void
 EthernetTransport::doLoop() {
+#if defined(ARDUINO_ARCH_ESP32)
+  while (m_impl != nullptr && m_impl->zeroCopyRx) {
+    pbuf* p = m_impl->popRetained();
+    if (p == nullptr) {
+      break;
+    }
+    const uint8_t* frame = reinterpret_cast<const uint8_t*>(p->payload);
+    invokeRxCallback(frame + sizeof(eth_hdr), p->len - sizeof(eth_hdr),
+                     endpointOf(reinterpret_cast<const eth_hdr*>(frame)));
+    detail::LwipLock lock;
+    pbuf_free(p);
+  }
+#endif
   loopRxQueue();
 }
 
 bool
 EthernetTransport::doSend(const uint8_t* pkt, size_t pktLen, uint64_t endpointId) {
-  if (m_impl == nullptr) {
+  TxFrame frame = allocTxFrame(pktLen);
+  if (frame.p == nullptr) {
     return false;
   }
+  return sendTxFrame(frame, pkt, pktLen, endpointId);
+}
 
-  uint16_t payloadLen = std::max<uint16_t>(pktLen, 46);
-  uint16_t frameSize = sizeof(eth_hdr) + payloadLen;
-  pbuf* p = pbuf_alloc(PBUF_RAW_TX, frameSize, PBUF_RAM);
-  if (p == nullptr) {
+bool
+EthernetTransport::setTxPool(size_t capacity) {
+  if (m_impl != nullptr) {
+    LOG(F("cannot change TX pool while active"));
     return false;
   }
-  p->len = p->tot_len = frameSize;
 
-  eth_hdr* eth = reinterpret_cast<eth_hdr*>(p->payload);
+  m_txPool.reset();
+  if (capacity == 0) {
+    return true;
+  }
+  m_txPool.reset(new TxPool(capacity));
+  if (m_txPool->capacity() < capacity) {
+    LOG(F("TX pool allocation error"));
+    m_txPool.reset();
+    return false;
+  }
+  return true;
+}
+
+EthernetTransport::TxFrame
+EthernetTransport::allocTxFrame(size_t pktLen) {
+  TxFrame frame;
+  if (m_impl == nullptr) {
+    return frame;
+  }
+
+  if (m_txPool != nullptr) {
+    if (m_txPool->alloc(frame)) {
+      return frame;
+    }
+    ++m_cnt.nTxPoolExhausted;
+  }
+
+  frame.roomLen = std::max<size_t>(pktLen, MinPayload);
+  {
+    detail::LwipLock lock;
+    frame.p = pbuf_alloc(PBUF_RAW_TX, sizeof(eth_hdr) + frame.roomLen, PBUF_RAM);
+  }
+  if (frame.p == nullptr) {
+    ++m_cnt.nTxAllocError;
+    return frame;
+  }
+  frame.room = reinterpret_cast<uint8_t*>(frame.p->payload) + sizeof(eth_hdr);
+  return frame;
+}
+
+bool
+EthernetTransport::sendTxFrame(TxFrame& frame, const uint8_t* pkt, size_t pktLen,
+                               uint64_t endpointId) {
+  if (m_impl == nullptr || pktLen > frame.roomLen) {
+    releaseTxFrame(frame);
+    return false;
+  }
+
+  // payload is placed at the end of the room, so that only the headroom needs adjustment;
+  // packet encoded in place is already there, and is moved only if it needs padding
+  size_t payloadLen = std::max<size_t>(pktLen, MinPayload);
+  uint8_t* pos = frame.room + frame.roomLen - payloadLen;
+  if (pos != pkt) {
+    memmove(pos, pkt, pktLen);
+  }
+  memset(pos + pktLen, 0, payloadLen - pktLen);
+
+  eth_hdr* eth = reinterpret_cast<eth_hdr*>(pos - sizeof(eth_hdr));
   EndpointId endpoint;
   endpoint.id = endpointId;
   if (endpointId == 0 || endpoint.isMulticast) {
@@ -222,14 +505,15 @@ EthernetTransport::doSend(const uint8_t* pkt, size_t pktLen, uint64_t endpointId
   }
   memcpy(&eth->src, m_impl->nif->hwaddr, sizeof(eth->src));
   eth->type = NDN_ETHERTYPE_BE;
-  memcpy(reinterpret_cast<uint8_t*>(p->payload) + sizeof(eth_hdr), pkt, pktLen);
-  if (pktLen < payloadLen) {
-    memset(reinterpret_cast<uint8_t*>(p->payload) + sizeof(eth_hdr) + pktLen, 0,
-           payloadLen - pktLen);
+
+  pbuf_remove_header(frame.p, reinterpret_cast<uint8_t*>(eth) -
+                                static_cast<uint8_t*>(frame.p->payload));
+  err_t e = m_impl->nif->linkoutput(m_impl->nif, frame.p);
+  if (frame.poolIndex >= 0) {
+    ++m_cnt.nTxPoolUsed;
   }
+  releaseTxFrame(frame);
 
-  err_t e = m_impl->nif->linkoutput(m_impl->nif, p);
-  pbuf_free(p);
   if (e != ERR_OK) {
     LOG(F("linkoutput error ") << _DEC(e));
     return false;
@@ -237,6 +521,20 @@ EthernetTransport::doSend(const uint8_t* pkt, size_t pktLen, uint64_t endpointId
   return true;
 }
 
+void
+EthernetTransport::releaseTxFrame(TxFrame& frame) {
+  if (frame.p == nullptr) {
+    return;
+  }
+  if (frame.poolIndex >= 0) {
+    m_txPool->release(frame.poolIndex);
+  } else {
+    detail::LwipLock lock;
+    pbuf_free(frame.p);
+  }
+  frame = TxFrame();
+}
+
 } // namespace esp8266ndn
 
 #endif // defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
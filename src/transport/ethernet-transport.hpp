@@ -5,13 +5,28 @@
 
 #include "../port/port.hpp"
 
+#if defined(ARDUINO_ARCH_ESP32)
+#include <sdkconfig.h>
+#endif
+
+#if defined(CONFIG_ESP_WIFI_DYNAMIC_RX_BUFFER_NUM)
+#define ESP8266NDN_ETHERNET_DRIVER_RX_BUFFERS CONFIG_ESP_WIFI_DYNAMIC_RX_BUFFER_NUM
+#elif defined(CONFIG_ESP32_WIFI_DYNAMIC_RX_BUFFER_NUM)
+#define ESP8266NDN_ETHERNET_DRIVER_RX_BUFFERS CONFIG_ESP32_WIFI_DYNAMIC_RX_BUFFER_NUM
+#else
+#define ESP8266NDN_ETHERNET_DRIVER_RX_BUFFERS 32
+#endif
+
 extern "C" {
 struct netif;
+struct pbuf;
 }
 class Print;
 
 namespace esp8266ndn {
 
+class PacketFilter;
+
 /** @brief A transport that communicates over Ethernet. */
 class EthernetTransport
   : public virtual ndnph::Transport
@@ -27,6 +42,8 @@ public:
   /**
    * @brief Start intercepting NDN packets on a network interface.
    * @return whether success.
+   *
+   * Up to @c MaxInstances instances may be active at the same time, each on a different netif.
    */
   bool begin(const char ifname[2], uint8_t ifnum);
 
@@ -39,6 +56,106 @@ public:
   /** @brief Disable the transport. */
   void end();
 
+  /**
+   * @brief Retain received frames in lwIP pbufs instead of copying them into RX buffers.
+   * @return whether success.
+   *
+   * This is supported on ESP32 only, and must be invoked while the transport is disabled.
+   * Received frames are queued as pbuf pointers, and the Face decodes each packet directly from
+   * the frame payload. Each pbuf is released after the Face has processed the packet.
+   * A retained pbuf occupies one of the Wi-Fi driver's RX buffers, so that at most
+   * @c ZeroCopyRxCapacity frames are retained; further frames are copied into RX buffers until
+   * the Face has processed some retained frames.
+   */
+  bool setZeroCopyRx(bool enable);
+
+  /**
+   * @brief Preallocate TX frames.
+   * @param capacity number of frames, each large enough for @c MaxPayload ; 0 disables the pool.
+   * @return whether success.
+   *
+   * This must be invoked while the transport is disabled.
+   * Outgoing packets are written into a pooled frame instead of a newly allocated pbuf.
+   * A frame is reused only after the network driver has released it. If no frame is available,
+   * a pbuf is allocated as usual, and @c Counters::nTxPoolExhausted is incremented.
+   */
+  bool setTxPool(size_t capacity);
+
+  /**
+   * @brief Set early RX filter.
+   * @param filter packet filter, or nullptr to accept every packet. It must remain valid while
+   *               the transport is enabled.
+   * @return whether success.
+   *
+   * This must be invoked while the transport is disabled.
+   * The filter is invoked in the network stack's packet input path, before the packet occupies an
+   * RX buffer or zero-copy RX slot. On ESP32, a frame received as a pbuf chain is filtered on its
+   * first pbuf only.
+   */
+  bool setRxFilter(const PacketFilter* filter);
+
+  /**
+   * @brief Encode a packet directly into a TX frame and transmit it.
+   * @tparam Packet encodable object, such as Interest or signed Data.
+   * @param endpointId destination EndpointId, 0 for multicast.
+   * @return whether success.
+   *
+   * The packet is encoded into the frame payload after headroom reserved for the Ethernet
+   * header, so that it is neither copied nor placed in a separate heap buffer.
+   */
+  template<typename Packet>
+  bool sendEncoded(const Packet& packet, uint64_t endpointId = 0) {
+    TxFrame frame = allocTxFrame(MaxPayload);
+    if (frame.p == nullptr) {
+      return false;
+    }
+    ndnph::Encoder encoder(frame.room, frame.roomLen);
+    if (!encoder.prepend(packet)) {
+      releaseTxFrame(frame);
+      return false;
+    }
+    return sendTxFrame(frame, encoder.begin(), encoder.size(), endpointId);
+  }
+
+  struct Counters {
+    /** @brief NDN frames accepted by RX filter, or all NDN frames if there is no filter. */
+    uint32_t nRxAccepted = 0;
+    /** @brief NDN frames rejected by RX filter. */
+    uint32_t nRxFiltered = 0;
+    /** @brief Frames received as pbuf chains and reassembled into RX buffers (ESP32 only). */
+    uint32_t nRxChained = 0;
+    /** @brief Frames received as pbuf chains but dropped because they could not be copied. */
+    uint32_t nRxChainedDropped = 0;
+    /** @brief Frames sent from TX pool. */
+    uint32_t nTxPoolUsed = 0;
+    /** @brief Frames sent from a temporary pbuf because every TX pool frame was busy. */
+    uint32_t nTxPoolExhausted = 0;
+    /** @brief Packets dropped because pbuf allocation failed. */
+    uint32_t nTxAllocError = 0;
+  };
+
+  /** @brief Read counters. */
+  Counters readCounters() const {
+    return m_cnt;
+  }
+
+public:
+  enum {
+    /**
+     * @brief Maximum number of frames retained in zero-copy RX mode.
+     *
+     * This is half of the Wi-Fi driver's dynamic RX buffers, so that other traffic on the netif
+     * can still be received while retained frames wait for the Face.
+     */
+    ZeroCopyRxCapacity = ESP8266NDN_ETHERNET_DRIVER_RX_BUFFERS / 2,
+
+    /** @brief Maximum number of simultaneously active instances, each on a different netif. */
+    MaxInstances = 4,
+
+    /** @brief Maximum NDN packet length in a frame, i.e. Ethernet MTU. */
+    MaxPayload = 1500,
+  };
+
 private:
   bool begin(netif* netif);
 
@@ -48,9 +165,38 @@ private:
 
   bool doSend(const uint8_t* pkt, size_t pktLen, uint64_t endpointId) final;
 
+  /** @brief Outgoing frame being prepared. */
+  struct TxFrame {
+    pbuf* p = nullptr;
+    uint8_t* room = nullptr; ///< payload area after Ethernet header
+    size_t roomLen = 0;
+    int poolIndex = -1; ///< index in TX pool, or -1 for temporary pbuf
+  };
+
+  /**
+   * @brief Obtain a TX frame.
+   * @param pktLen maximum packet length to be placed in the frame.
+   */
+  TxFrame allocTxFrame(size_t pktLen);
+
+  /**
+   * @brief Transmit a frame.
+   * @param pkt packet, either within @c frame.room or elsewhere.
+   *
+   * The frame is released.
+   */
+  bool sendTxFrame(TxFrame& frame, const uint8_t* pkt, size_t pktLen, uint64_t endpointId);
+
+  void releaseTxFrame(TxFrame& frame);
+
 private:
   class Impl;
   std::unique_ptr<Impl> m_impl;
+  class TxPool;
+  std::unique_ptr<TxPool> m_txPool;
+  const PacketFilter* m_rxFilter = nullptr;
+  bool m_zeroCopyRx = false;
+  Counters m_cnt;
 };
 
 } // namespace esp8266ndn
@@ -0,0 +1,323 @@
+#include "lp-fragmentation.hpp"
+#include "tlv-decode.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace esp8266ndn {
+
+namespace {
+
+using detail::readNni;
+using detail::readTypeLength;
+using detail::sizeofVarNum;
+using detail::TtLpFragCount;
+using detail::TtLpFragIndex;
+using detail::TtLpFragment;
+using detail::TtLpPacket;
+using detail::TtLpSequence;
+using detail::writeVarNum;
+
+/** @brief Write a 2-octet NonNegativeInteger element. */
+uint8_t*
+writeNni16(uint8_t* pos, uint8_t type, uint16_t n) {
+  *pos++ = type;
+  *pos++ = 2;
+  *pos++ = n >> 8;
+  *pos++ = n;
+  return pos;
+}
+
+} // anonymous namespace
+
+LpFragmenter::LpFragmenter(size_t maxFrameLen)
+  : m_frame(new uint8_t[maxFrameLen])
+  , m_maxFrameLen(maxFrameLen) {}
+
+size_t
+LpFragmenter::begin(const uint8_t* pkt, size_t pktLen, size_t mtu) {
+  m_pkt = nullptr;
+  m_index = m_count = 0;
+  if (pktLen <= mtu) {
+    m_pkt = pkt;
+    m_payloadLen = pktLen;
+    return 1;
+  }
+  if (mtu > m_maxFrameLen || mtu <= Overhead) {
+    return 0;
+  }
+
+  const uint8_t* pos = pkt;
+  const uint8_t* end = pkt + pktLen;
+  uint32_t type = 0, length = 0;
+  if (!readTypeLength(pos, end, type, length) || static_cast<size_t>(end - pos) != length) {
+    return 0;
+  }
+  m_headers = nullptr;
+  m_headersLen = 0;
+  m_payload = pkt;
+  m_payloadLen = pktLen;
+
+  if (type == TtLpPacket) {
+    m_headers = pos;
+    m_payload = nullptr;
+    while (pos < end) {
+      const uint8_t* field = pos;
+      if (!readTypeLength(pos, end, type, length) || static_cast<size_t>(end - pos) < length) {
+        return 0;
+      }
+      switch (type) {
+        case TtLpSequence:
+        case TtLpFragIndex:
+        case TtLpFragCount:
+          return 0; // already fragmented
+        case TtLpFragment:
+          m_headersLen = field - m_headers;
+          m_payload = pos;
+          m_payloadLen = length;
+          break;
+      }
+      pos += length;
+    }
+    if (m_payload == nullptr) {
+      return 0;
+    }
+  }
+
+  if (mtu <= Overhead + m_headersLen) {
+    return 0;
+  }
+  size_t firstRoom = mtu - Overhead - m_headersLen;
+  size_t room = mtu - Overhead;
+  size_t count = 1;
+  if (m_payloadLen > firstRoom) {
+    count += (m_payloadLen - firstRoom + room - 1) / room;
+  }
+  if (count > UINT16_MAX) {
+    return 0;
+  }
+
+  m_mtu = mtu;
+  m_count = count;
+  return count;
+}
+
+size_t
+LpFragmenter::next(const uint8_t*& frame) {
+  if (m_pkt != nullptr) {
+    frame = m_pkt;
+    m_pkt = nullptr;
+    return m_payloadLen;
+  }
+  if (m_index >= m_count) {
+    return 0;
+  }
+
+  size_t firstRoom = m_mtu - Overhead - m_headersLen;
+  size_t room = m_mtu - Overhead;
+  size_t offset = m_index == 0 ? 0 : firstRoom + (m_index - 1) * room;
+  size_t chunkLen = std::min(m_index == 0 ? firstRoom : room, m_payloadLen - offset);
+  size_t headersLen = m_index == 0 ? m_headersLen : 0;
+  size_t innerLen = 10 + 4 + 4 + headersLen + 1 + sizeofVarNum(chunkLen) + chunkLen;
+
+  uint8_t* pos = m_frame.get();
+  *pos++ = TtLpPacket;
+  pos = writeVarNum(pos, innerLen);
+  *pos++ = TtLpSequence;
+  *pos++ = 8;
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    *pos++ = m_seq >> shift;
+  }
+  pos = writeNni16(pos, TtLpFragIndex, m_index);
+  pos = writeNni16(pos, TtLpFragCount, m_count);
+  std::copy_n(m_headers, headersLen, pos);
+  pos += headersLen;
+  *pos++ = TtLpFragment;
+  pos = writeVarNum(pos, chunkLen);
+  std::copy_n(m_payload + offset, chunkLen, pos);
+  pos += chunkLen;
+
+  ++m_seq;
+  ++m_index;
+  frame = m_frame.get();
+  return pos - m_frame.get();
+}
+
+struct LpReassembler::Slot {
+  uint64_t link = 0;
+  uint64_t seqBase = 0;
+  uint8_t* buf = nullptr; ///< headroom followed by payload
+  size_t payloadLen = 0;
+  uint16_t count = 0;
+  uint16_t next = 0;
+  uint8_t headersLen = 0;
+  bool isAssigned = false;
+  bool isActive = false;
+  uint8_t headers[MaxHeadersLen];
+};
+
+LpReassembler::LpReassembler(size_t nSlots, size_t maxPktLen)
+  : m_slots(new Slot[nSlots])
+  , m_buf(new uint8_t[nSlots * (ReassemblyHeadroom + maxPktLen)])
+  , m_nSlots(nSlots)
+  , m_maxPktLen(maxPktLen) {
+  for (size_t i = 0; i < nSlots; ++i) {
+    m_slots[i].buf = &m_buf[i * (ReassemblyHeadroom + maxPktLen)];
+  }
+}
+
+LpReassembler::~LpReassembler() = default;
+
+LpReassembler::Slot&
+LpReassembler::findSlot(uint64_t link) {
+  Slot* free = nullptr;
+  Slot* idle = nullptr;
+  for (size_t i = 0; i < m_nSlots; ++i) {
+    Slot& slot = m_slots[i];
+    if (slot.isAssigned && slot.link == link) {
+      return slot;
+    }
+    if (!slot.isAssigned && free == nullptr) {
+      free = &slot;
+    } else if (slot.isAssigned && !slot.isActive && idle == nullptr) {
+      idle = &slot;
+    }
+  }
+
+  // take over a slot of a closed or idle link before evicting a partial packet
+  if (free == nullptr) {
+    free = idle;
+  }
+  if (free == nullptr) {
+    free = &m_slots[m_nextEvict];
+    m_nextEvict = (m_nextEvict + 1) % m_nSlots;
+    discard(*free);
+  }
+  free->isAssigned = true;
+  free->link = link;
+  return *free;
+}
+
+void
+LpReassembler::discard(Slot& slot) {
+  if (slot.isActive) {
+    m_cnt.nDropped += slot.next;
+    slot.isActive = false;
+  }
+}
+
+LpReassembler::Result
+LpReassembler::process(uint64_t link, const uint8_t* frame, size_t frameLen, const uint8_t*& pkt,
+                       size_t& pktLen) {
+  const uint8_t* pos = frame;
+  const uint8_t* end = frame + frameLen;
+  uint32_t type = 0, length = 0;
+  if (!readTypeLength(pos, end, type, length) || type != TtLpPacket ||
+      static_cast<size_t>(end - pos) != length) {
+    return Result::Pass;
+  }
+
+  const uint8_t* fields = pos;
+  uint64_t seq = 0, index = 0, count = 1;
+  bool hasSeq = false;
+  const uint8_t* fragment = nullptr;
+  size_t fragmentLen = 0;
+  while (pos < end) {
+    if (!readTypeLength(pos, end, type, length) || static_cast<size_t>(end - pos) < length) {
+      return Result::Pass;
+    }
+    switch (type) {
+      case TtLpSequence:
+        hasSeq = readNni(pos, length, seq);
+        break;
+      case TtLpFragIndex:
+        readNni(pos, length, index);
+        break;
+      case TtLpFragCount:
+        readNni(pos, length, count);
+        break;
+      case TtLpFragment:
+        fragment = pos;
+        fragmentLen = length;
+        break;
+    }
+    pos += length;
+  }
+  if (count <= 1) {
+    return Result::Pass;
+  }
+
+  if (!hasSeq || fragment == nullptr || index >= count || count > UINT16_MAX) {
+    ++m_cnt.nDropped;
+    return Result::Dropped;
+  }
+  Slot& slot = findSlot(link);
+
+  if (index == 0) {
+    discard(slot);
+    slot.seqBase = seq;
+    slot.count = count;
+    slot.next = 0;
+    slot.payloadLen = 0;
+    slot.headersLen = 0;
+    for (pos = fields; pos < end;) {
+      const uint8_t* field = pos;
+      readTypeLength(pos, end, type, length);
+      pos += length;
+      if (type == TtLpSequence || type == TtLpFragIndex || type == TtLpFragCount ||
+          type == TtLpFragment) {
+        continue;
+      }
+      size_t fieldLen = pos - field;
+      if (slot.headersLen + fieldLen > MaxHeadersLen) {
+        ++m_cnt.nDropped;
+        return Result::Dropped;
+      }
+      std::copy_n(field, fieldLen, &slot.headers[slot.headersLen]);
+      slot.headersLen += fieldLen;
+    }
+    slot.isActive = true;
+  } else if (!slot.isActive || seq != slot.seqBase + index || index != slot.next ||
+             count != slot.count) {
+    discard(slot);
+    ++m_cnt.nDropped;
+    return Result::Dropped;
+  }
+
+  uint8_t* payload = slot.buf + ReassemblyHeadroom;
+  if (slot.payloadLen + fragmentLen > m_maxPktLen) {
+    discard(slot);
+    ++m_cnt.nDropped;
+    return Result::Dropped;
+  }
+  std::memcpy(payload + slot.payloadLen, fragment, fragmentLen);
+  slot.payloadLen += fragmentLen;
+  if (++slot.next < slot.count) {
+    return Result::Accepted;
+  }
+  slot.isActive = false;
+  ++m_cnt.nDelivered;
+
+  pktLen = slot.payloadLen;
+  pkt = payload;
+  if (slot.headersLen == 0) {
+    return Result::Complete;
+  }
+
+  // prepend header fields and wrap in LpPacket
+  uint8_t* head = payload - 1 - sizeofVarNum(slot.payloadLen);
+  writeVarNum(head + 1, slot.payloadLen);
+  head[0] = TtLpFragment;
+  head -= slot.headersLen;
+  std::copy_n(slot.headers, slot.headersLen, head);
+  size_t innerLen = payload + slot.payloadLen - head;
+  head -= 1 + sizeofVarNum(innerLen);
+  writeVarNum(head + 1, innerLen);
+  head[0] = TtLpPacket;
+
+  pkt = head;
+  pktLen = payload + slot.payloadLen - head;
+  return Result::Complete;
+}
+
+} // namespace esp8266ndn
@@ -0,0 +1,140 @@
+#ifndef ESP8266NDN_TRANSPORT_LP_FRAGMENTATION_HPP
+#define ESP8266NDN_TRANSPORT_LP_FRAGMENTATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace esp8266ndn {
+
+/**
+ * @brief NDNLPv2 fragmenter operating on encoded packets.
+ *
+ * Unlike ndnph::lp::Fragmenter, the MTU may differ on every packet, so that a transport can
+ * fragment according to the MTU of each link. If the input is an LpPacket, its header fields are
+ * placed in the first fragment.
+ */
+class LpFragmenter {
+public:
+  /** @param maxFrameLen maximum MTU passed to begin(). */
+  explicit LpFragmenter(size_t maxFrameLen);
+
+  /**
+   * @brief Start fragmenting a packet.
+   * @param pkt packet, which must remain valid until next() returns 0.
+   * @param mtu maximum frame length.
+   * @return number of frames, or 0 if the packet cannot be fragmented.
+   *
+   * If the packet fits in MTU, it is returned as the only frame without modification.
+   */
+  size_t begin(const uint8_t* pkt, size_t pktLen, size_t mtu);
+
+  /**
+   * @brief Retrieve next frame.
+   * @param[out] frame frame pointer, valid until next invocation.
+   * @return frame length, or 0 if there are no more frames.
+   */
+  size_t next(const uint8_t*& frame);
+
+public:
+  enum {
+    /** @brief Per-frame overhead: LpPacket, Sequence, FragIndex, FragCount, Fragment TL. */
+    Overhead = 4 + 10 + 4 + 4 + 4,
+  };
+
+private:
+  std::unique_ptr<uint8_t[]> m_frame;
+  size_t m_maxFrameLen;
+  uint64_t m_seq = 0;
+
+  const uint8_t* m_pkt = nullptr; ///< unfragmented packet to be returned as is
+  const uint8_t* m_headers = nullptr;
+  size_t m_headersLen = 0;
+  const uint8_t* m_payload = nullptr;
+  size_t m_payloadLen = 0;
+  size_t m_mtu = 0;
+  uint16_t m_index = 0;
+  uint16_t m_count = 0;
+};
+
+/**
+ * @brief NDNLPv2 reassembler with a preallocated slot for each link.
+ *
+ * Fragments of a packet must arrive in order, which is guaranteed by BLE. An out-of-order
+ * fragment causes the partially reassembled packet to be discarded.
+ *
+ * When every slot is assigned, a new link takes over a slot without a partial packet, such as one
+ * of a closed connection. A partial packet is evicted only if every slot is reassembling.
+ */
+class LpReassembler {
+public:
+  enum class Result {
+    Pass,     ///< frame is not fragmented, and should be processed as is
+    Accepted, ///< fragment is accepted, packet is incomplete
+    Complete, ///< packet is complete
+    Dropped,  ///< fragment is dropped
+  };
+
+  struct Counters {
+    /** @brief Packets reassembled. */
+    uint32_t nDelivered = 0;
+    /** @brief Fragments dropped, including those in discarded partial packets. */
+    uint32_t nDropped = 0;
+  };
+
+  /**
+   * @param nSlots number of links that may reassemble packets at the same time.
+   * @param maxPktLen maximum reassembled packet length.
+   */
+  explicit LpReassembler(size_t nSlots, size_t maxPktLen);
+
+  ~LpReassembler();
+
+  /**
+   * @brief Process a received frame.
+   * @param link link identifier, such as EndpointId.
+   * @param[out] pkt reassembled packet, valid until next invocation on the same link.
+   * @param[out] pktLen reassembled packet length.
+   *
+   * The reassembled packet is a bare network layer packet, or an LpPacket carrying the header
+   * fields of the first fragment.
+   */
+  Result process(uint64_t link, const uint8_t* frame, size_t frameLen, const uint8_t*& pkt,
+                 size_t& pktLen);
+
+  /** @brief Read counters. */
+  Counters readCounters() const {
+    return m_cnt;
+  }
+
+public:
+  enum {
+    /** @brief Maximum length of header fields retained from the first fragment. */
+    MaxHeadersLen = 48,
+    /**
+     * @brief Maximum length of LpPacket TL, header fields, and Fragment TL.
+     *
+     * A reassembled packet wrapped in LpPacket may exceed maxPktLen by this many octets.
+     */
+    ReassemblyHeadroom = 4 + MaxHeadersLen + 4,
+  };
+
+private:
+  struct Slot;
+
+  Slot& findSlot(uint64_t link);
+
+  void discard(Slot& slot);
+
+private:
+  std::unique_ptr<Slot[]> m_slots;
+  std::unique_ptr<uint8_t[]> m_buf;
+  size_t m_nSlots;
+  size_t m_maxPktLen;
+  size_t m_nextEvict = 0;
+  Counters m_cnt;
+};
+
+} // namespace esp8266ndn
+
+#endif // ESP8266NDN_TRANSPORT_LP_FRAGMENTATION_HPP
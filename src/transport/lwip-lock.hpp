@@ -0,0 +1,38 @@
+#ifndef ESP8266NDN_TRANSPORT_LWIP_LOCK_HPP
+#define ESP8266NDN_TRANSPORT_LWIP_LOCK_HPP
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+
+#include <lwip/opt.h>
+#if defined(ARDUINO_ARCH_ESP32)
+#include <lwip/tcpip.h>
+#endif
+
+namespace esp8266ndn {
+namespace detail {
+
+/** @brief Hold lwIP core lock while invoking raw API outside of lwIP context. */
+class LwipLock {
+public:
+  LwipLock() {
+#if defined(ARDUINO_ARCH_ESP32) && LWIP_TCPIP_CORE_LOCKING
+    LOCK_TCPIP_CORE();
+#endif
+  }
+
+  ~LwipLock() {
+#if defined(ARDUINO_ARCH_ESP32) && LWIP_TCPIP_CORE_LOCKING
+    UNLOCK_TCPIP_CORE();
+#endif
+  }
+
+  LwipLock(const LwipLock&) = delete;
+  LwipLock& operator=(const LwipLock&) = delete;
+};
+
+} // namespace detail
+} // namespace esp8266ndn
+
+#endif // defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+
+#endif // ESP8266NDN_TRANSPORT_LWIP_LOCK_HPP
@@ -0,0 +1,141 @@
+#include "packet-filter.hpp"
+#include "tlv-decode.hpp"
+
+#include <algorithm>
+
+namespace esp8266ndn {
+
+namespace {
+
+using detail::LpHeaders;
+using detail::readTypeLength;
+using detail::skipLpHeaders;
+using detail::TtInterest;
+using detail::TtLpPacket;
+using detail::TtName;
+
+constexpr uint32_t FnvOffset = 2166136261;
+constexpr uint32_t FnvPrime = 16777619;
+
+/** @brief Feed bytes into FNV-1a hash. */
+uint32_t
+fnv1a(uint32_t h, const uint8_t* first, const uint8_t* last) {
+  for (; first != last; ++first) {
+    h = (h ^ *first) * FnvPrime;
+  }
+  return h;
+}
+
+} // anonymous namespace
+
+static_assert(PrefixFilter::NBits == 256, "setBits and testBits use 8-bit indices");
+
+bool
+PrefixFilter::addPrefix(const uint8_t* nameValue, size_t nameValueLen) {
+  const uint8_t* pos = nameValue;
+  const uint8_t* end = nameValue + nameValueLen;
+  uint32_t h = FnvOffset;
+  int depth = 0;
+  while (pos < end) {
+    const uint8_t* comp = pos;
+    uint32_t type = 0, length = 0;
+    if (!readTypeLength(pos, end, type, length) || static_cast<size_t>(end - pos) < length ||
+        ++depth > MaxPrefixComponents) {
+      return false;
+    }
+    pos += length;
+    h = fnv1a(h, comp, pos);
+  }
+
+  m_depths |= static_cast<uint64_t>(1) << depth;
+  setBits(h);
+  return true;
+}
+
+void
+PrefixFilter::clear() {
+  std::fill(std::begin(m_bits), std::end(m_bits), 0);
+  m_depths = 0;
+}
+
+bool
+PrefixFilter::accept(const uint8_t* pkt, size_t pktLen) const {
+  const uint8_t* pos = pkt;
+  const uint8_t* end = pkt + pktLen;
+  uint32_t type = 0, length = 0;
+  if (!readTypeLength(pos, end, type, length)) {
+    return true;
+  }
+
+  if (type == TtLpPacket) {
+    end = pos + std::min<size_t>(length, end - pos);
+    LpHeaders lp;
+    // name is visible in first fragment of an Interest only
+    if (!skipLpHeaders(pos, end, lp) || lp.isNack || !lp.isFirstFragment ||
+        !readTypeLength(pos, end, type, length)) {
+      return true;
+    }
+  }
+
+  if (type != TtInterest) {
+    return true;
+  }
+  if (!readTypeLength(pos, end, type, length) || type != TtName) {
+    return true;
+  }
+  size_t visible = std::min<size_t>(length, end - pos);
+  return acceptName(pos, visible, visible < length);
+}
+
+bool
+PrefixFilter::acceptName(const uint8_t* nameValue, size_t nameValueLen, bool isTruncated) const {
+  if (m_depths == 0) {
+    return false;
+  }
+  if ((m_depths & 0x01) != 0) {
+    return true;
+  }
+  int maxDepth = 63 - __builtin_clzll(m_depths);
+
+  const uint8_t* pos = nameValue;
+  const uint8_t* end = nameValue + nameValueLen;
+  uint32_t h = FnvOffset;
+  int depth = 0;
+  // every prefix length up to maxDepth has been checked when the loop exits
+  while (pos < end && depth < maxDepth) {
+    const uint8_t* comp = pos;
+    uint32_t type = 0, length = 0;
+    if (!readTypeLength(pos, end, type, length) || static_cast<size_t>(end - pos) < length) {
+      return true; // truncated or malformed, let the Face decide
+    }
+    pos += length;
+    h = fnv1a(h, comp, pos);
+
+    ++depth;
+    if ((m_depths & (static_cast<uint64_t>(1) << depth)) != 0 && testBits(h)) {
+      return true;
+    }
+  }
+  return isTruncated && depth < maxDepth;
+}
+
+void
+PrefixFilter::setBits(uint32_t h) {
+  for (int i = 0; i < 3; ++i, h >>= 8) {
+    uint8_t bit = h & 0xFF;
+    m_bits[bit >> 3] |= 1 << (bit & 0x07);
+  }
+}
+
+bool
+PrefixFilter::testBits(uint32_t h) const {
+  for (int i = 0; i < 3; ++i, h >>= 8) {
+    uint8_t bit = h & 0xFF;
+    if ((m_bits[bit >> 3] & (1 << (bit & 0x07))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace esp8266ndn
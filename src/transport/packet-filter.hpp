@@ -0,0 +1,81 @@
+#ifndef ESP8266NDN_TRANSPORT_PACKET_FILTER_HPP
+#define ESP8266NDN_TRANSPORT_PACKET_FILTER_HPP
+
+#include "../port/port.hpp"
+
+namespace esp8266ndn {
+
+/**
+ * @brief Early filter of received packets, invoked before a packet is queued for the Face.
+ *
+ * accept() may be invoked from the network stack's context, so that it must not block or
+ * allocate memory. It may see a truncated prefix of the packet, in which case it should accept
+ * the packet unless the visible portion is sufficient to reject it.
+ */
+class PacketFilter {
+public:
+  virtual ~PacketFilter() = default;
+
+  /**
+   * @brief Determine whether a packet should be accepted.
+   * @param pkt NDN packet, possibly wrapped in NDNLPv2.
+   * @param pktLen available length, which may be shorter than the packet.
+   */
+  virtual bool accept(const uint8_t* pkt, size_t pktLen) const = 0;
+};
+
+/**
+ * @brief Accept Interests under a set of name prefixes, and every other packet.
+ *
+ * Name prefixes are stored in a Bloom filter, so that memory usage is constant regardless of
+ * how many prefixes are added. A false positive causes an unwanted Interest to be accepted and
+ * then dropped by the Face, while a wanted Interest is never rejected. Prefixes cannot be
+ * removed, except by clearing the whole filter.
+ *
+ * Data and Nack are always accepted, because they are matched against pending Interests.
+ * NDNLPv2 fragments other than the first are also accepted, because their name is not visible.
+ */
+class PrefixFilter : public PacketFilter {
+public:
+  /**
+   * @brief Add a name prefix.
+   * @param nameValue TLV-VALUE of Name element.
+   * @return whether success; false if the name is malformed or has too many components.
+   */
+  bool addPrefix(const uint8_t* nameValue, size_t nameValueLen);
+
+  /** @brief Add a name prefix. */
+  bool addPrefix(const ndnph::Name& name) {
+    return addPrefix(name.value(), name.length());
+  }
+
+  /** @brief Remove all prefixes, so that every Interest is rejected. */
+  void clear();
+
+  bool accept(const uint8_t* pkt, size_t pktLen) const override;
+
+public:
+  enum {
+    /** @brief Bloom filter size in bits. */
+    NBits = 256,
+    /** @brief Maximum number of name components in a prefix. */
+    MaxPrefixComponents = 32,
+  };
+
+private:
+  /** @brief Determine whether an Interest name matches a prefix. */
+  bool acceptName(const uint8_t* nameValue, size_t nameValueLen, bool isTruncated) const;
+
+  void setBits(uint32_t h);
+
+  bool testBits(uint32_t h) const;
+
+private:
+  uint8_t m_bits[NBits / 8] = {};
+  /** @brief Bitmask of prefix lengths in components, bit 0 means the empty prefix. */
+  uint64_t m_depths = 0;
+};
+
+} // namespace esp8266ndn
+
+#endif // ESP8266NDN_TRANSPORT_PACKET_FILTER_HPP
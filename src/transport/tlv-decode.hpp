@@ -0,0 +1,128 @@
+#ifndef ESP8266NDN_TRANSPORT_TLV_DECODE_HPP
+#define ESP8266NDN_TRANSPORT_TLV_DECODE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace esp8266ndn {
+namespace detail {
+
+/** @brief TLV-TYPE numbers used by transports, packet filters, and path MTU probes. */
+enum : uint32_t {
+  TtInterest = 0x05,
+  TtData = 0x06,
+  TtName = 0x07,
+  TtLpPacket = 0x64,
+  TtLpFragment = 0x50,
+  TtLpSequence = 0x51,
+  TtLpFragIndex = 0x52,
+  TtLpFragCount = 0x53,
+  TtLpNack = 0x0320,
+  /** @brief Unassigned NDNLPv2 header field, ignorable because its two lowest bits are 00. */
+  TtLpPadding = 0x03BC,
+};
+
+/** @brief Read TLV-TYPE or TLV-LENGTH number, up to 32 bits. */
+inline bool
+readVarNum(const uint8_t*& pos, const uint8_t* end, uint32_t& n) {
+  if (pos == end) {
+    return false;
+  }
+  uint8_t first = *pos++;
+  if (first < 0xFD) {
+    n = first;
+    return true;
+  }
+  size_t extra = first == 0xFD ? 2 : first == 0xFE ? 4 : 8;
+  if (extra > 4 || static_cast<size_t>(end - pos) < extra) {
+    return false;
+  }
+  n = 0;
+  for (size_t i = 0; i < extra; ++i) {
+    n = (n << 8) | *pos++;
+  }
+  return true;
+}
+
+/** @brief Read TLV-TYPE and TLV-LENGTH; TLV-VALUE may extend beyond @p end . */
+inline bool
+readTypeLength(const uint8_t*& pos, const uint8_t* end, uint32_t& type, uint32_t& length) {
+  return readVarNum(pos, end, type) && readVarNum(pos, end, length);
+}
+
+/** @brief Decode NonNegativeInteger or fixed-width unsigned integer, up to 8 octets. */
+inline bool
+readNni(const uint8_t* value, size_t length, uint64_t& n) {
+  if (length == 0 || length > 8) {
+    return false;
+  }
+  n = 0;
+  for (size_t i = 0; i < length; ++i) {
+    n = (n << 8) | value[i];
+  }
+  return true;
+}
+
+/** @brief Compute encoded size of TLV-TYPE or TLV-LENGTH number below 65536. */
+inline size_t
+sizeofVarNum(size_t n) {
+  return n < 0xFD ? 1 : 3;
+}
+
+/** @brief Write TLV-TYPE or TLV-LENGTH number below 65536. */
+inline uint8_t*
+writeVarNum(uint8_t* pos, size_t n) {
+  if (n < 0xFD) {
+    *pos++ = static_cast<uint8_t>(n);
+  } else {
+    *pos++ = 0xFD;
+    *pos++ = static_cast<uint8_t>(n >> 8);
+    *pos++ = static_cast<uint8_t>(n);
+  }
+  return pos;
+}
+
+/** @brief NDNLPv2 header fields that affect packet classification. */
+struct LpHeaders {
+  bool isNack = false;
+  bool isFirstFragment = true; ///< FragIndex is absent or zero
+};
+
+/**
+ * @brief Skip LpPacket header fields up to Fragment.
+ * @param[inout] pos start of LpPacket TLV-VALUE; advanced to start of Fragment TLV-VALUE.
+ * @param[inout] end end of LpPacket TLV-VALUE; changed to end of visible Fragment TLV-VALUE,
+ *                   which may be truncated.
+ * @return whether Fragment is found.
+ */
+inline bool
+skipLpHeaders(const uint8_t*& pos, const uint8_t*& end, LpHeaders& headers) {
+  while (true) {
+    uint32_t type = 0, length = 0;
+    if (!readTypeLength(pos, end, type, length)) {
+      return false;
+    }
+    if (type == TtLpFragment) {
+      end = pos + std::min<size_t>(length, end - pos);
+      return true;
+    }
+    if (static_cast<size_t>(end - pos) < length) {
+      return false;
+    }
+    switch (type) {
+      case TtLpFragIndex:
+        headers.isFirstFragment = std::all_of(pos, pos + length, [](uint8_t b) { return b == 0; });
+        break;
+      case TtLpNack:
+        headers.isNack = true;
+        break;
+    }
+    pos += length;
+  }
+}
+
+} // namespace detail
+} // namespace esp8266ndn
+
+#endif // ESP8266NDN_TRANSPORT_TLV_DECODE_HPP
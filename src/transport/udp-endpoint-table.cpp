@@ -0,0 +1,180 @@
+#include "udp-endpoint-table.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace esp8266ndn {
+
+namespace {
+
+constexpr uint16_t NIL = 0xFFFF;
+
+/**
+ * @brief EndpointId flag of a directly encoded IPv4 endpoint.
+ *
+ * Table EndpointIds have a 32-bit generation number above a 16-bit index, so that they never
+ * have this bit.
+ */
+constexpr uint64_t IPV4_FLAG = static_cast<uint64_t>(1) << 48;
+
+} // anonymous namespace
+
+UdpEndpointTable::UdpEndpointTable(size_t capacity) {
+  resize(std::min<size_t>(std::max<size_t>(capacity, 1), MaxCapacity));
+}
+
+bool
+UdpEndpointTable::resize(size_t capacity) {
+  if (capacity == 0 || capacity > MaxCapacity) {
+    return false;
+  }
+
+  size_t nBuckets = 1;
+  while (nBuckets < 2 * capacity) {
+    nBuckets <<= 1;
+  }
+
+  m_entries.reset(new Entry[capacity]);
+  m_buckets.reset(new uint16_t[nBuckets]);
+  std::fill_n(m_buckets.get(), nBuckets, NIL);
+  m_capacity = capacity;
+  m_nBuckets = nBuckets;
+  m_nUsed = 0;
+  m_lruHead = m_lruTail = NIL;
+  return true;
+}
+
+uint16_t&
+UdpEndpointTable::bucketOf(const uint8_t* addr, size_t addrLen, uint16_t port) {
+  // FNV-1a
+  uint32_t h = 2166136261;
+  for (size_t i = 0; i < addrLen; ++i) {
+    h = (h ^ addr[i]) * 16777619;
+  }
+  h = (h ^ (port >> 8)) * 16777619;
+  h = (h ^ (port & 0xFF)) * 16777619;
+  return m_buckets[h & (m_nBuckets - 1)];
+}
+
+void
+UdpEndpointTable::lruUnlink(uint16_t index) {
+  Entry& entry = m_entries[index];
+  if (entry.lruPrev == NIL) {
+    m_lruHead = entry.lruNext;
+  } else {
+    m_entries[entry.lruPrev].lruNext = entry.lruNext;
+  }
+  if (entry.lruNext == NIL) {
+    m_lruTail = entry.lruPrev;
+  } else {
+    m_entries[entry.lruNext].lruPrev = entry.lruPrev;
+  }
+}
+
+void
+UdpEndpointTable::lruPushFront(uint16_t index) {
+  Entry& entry = m_entries[index];
+  entry.lruPrev = NIL;
+  entry.lruNext = m_lruHead;
+  if (m_lruHead == NIL) {
+    m_lruTail = index;
+  } else {
+    m_entries[m_lruHead].lruPrev = index;
+  }
+  m_lruHead = index;
+}
+
+void
+UdpEndpointTable::evict(uint16_t index) {
+  Entry& entry = m_entries[index];
+  for (uint16_t* link = &bucketOf(entry.addr, entry.addrLen, entry.port); *link != NIL;
+       link = &m_entries[*link].hashNext) {
+    if (*link == index) {
+      *link = entry.hashNext;
+      break;
+    }
+  }
+  lruUnlink(index);
+  entry.gen = 0;
+  ++m_cnt.nEvictions;
+}
+
+uint64_t
+UdpEndpointTable::encode(const uint8_t* addr, size_t addrLen, uint16_t port) {
+  if (addrLen == 4) {
+    return IPV4_FLAG | (static_cast<uint64_t>(addr[0]) << 40) |
+           (static_cast<uint64_t>(addr[1]) << 32) | (static_cast<uint64_t>(addr[2]) << 24) |
+           (static_cast<uint64_t>(addr[3]) << 16) | port;
+  }
+  if (addrLen != 16 || m_capacity == 0) {
+    return 0;
+  }
+
+  uint16_t& bucket = bucketOf(addr, addrLen, port);
+  uint16_t index = bucket;
+  for (; index != NIL; index = m_entries[index].hashNext) {
+    const Entry& entry = m_entries[index];
+    if (entry.port == port && entry.addrLen == addrLen &&
+        std::equal(addr, addr + addrLen, entry.addr)) {
+      break;
+    }
+  }
+
+  if (index != NIL) {
+    ++m_cnt.nReuses;
+    if (m_lruHead != index) {
+      lruUnlink(index);
+      lruPushFront(index);
+    }
+  } else {
+    if (m_nUsed < m_capacity) {
+      index = static_cast<uint16_t>(m_nUsed++);
+    } else {
+      index = m_lruTail;
+      evict(index);
+    }
+
+    Entry& entry = m_entries[index];
+    if (++m_lastGen == 0) {
+      ++m_lastGen;
+    }
+    entry.gen = m_lastGen;
+    entry.port = port;
+    entry.addrLen = static_cast<uint8_t>(addrLen);
+    std::copy_n(addr, addrLen, entry.addr);
+    entry.hashNext = bucket;
+    bucket = index;
+    lruPushFront(index);
+    ++m_cnt.nInserts;
+  }
+
+  return (static_cast<uint64_t>(m_entries[index].gen) << 16) | (index + 1);
+}
+
+size_t
+UdpEndpointTable::decode(uint64_t endpointId, uint8_t addr[16], uint16_t* port) {
+  if ((endpointId >> 48) == (IPV4_FLAG >> 48)) {
+    for (int i = 0; i < 4; ++i) {
+      addr[i] = static_cast<uint8_t>(endpointId >> (40 - 8 * i));
+    }
+    *port = static_cast<uint16_t>(endpointId);
+    return 4;
+  }
+
+  uint16_t index = static_cast<uint16_t>(endpointId) - 1;
+  uint64_t gen = endpointId >> 16;
+  if (index >= m_nUsed || m_entries[index].gen != gen) {
+    return 0;
+  }
+
+  const Entry& entry = m_entries[index];
+  std::copy_n(entry.addr, entry.addrLen, addr);
+  *port = entry.port;
+  if (m_lruHead != index) {
+    lruUnlink(index);
+    lruPushFront(index);
+  }
+  return entry.addrLen;
+}
+
+} // namespace esp8266ndn
@@ -0,0 +1,110 @@
+#ifndef ESP8266NDN_TRANSPORT_UDP_ENDPOINT_TABLE_HPP
+#define ESP8266NDN_TRANSPORT_UDP_ENDPOINT_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace esp8266ndn {
+
+/**
+ * @brief Table of remote UDP endpoints, assigning an EndpointId to each address and port.
+ *
+ * IPv4 endpoints are encoded directly into the EndpointId and do not occupy table entries.
+ * IPv6 endpoints are stored in the table; both directions of lookup are O(1) on average.
+ * When the table is full, the least recently used entry is evicted and its EndpointId becomes
+ * invalid.
+ */
+class UdpEndpointTable {
+public:
+  /** @brief Table counters; IPv4 endpoints are not counted. */
+  struct Counters {
+    /** @brief Endpoints inserted into the table. */
+    uint32_t nInserts = 0;
+    /** @brief Lookups that found an existing entry. */
+    uint32_t nReuses = 0;
+    /** @brief Entries evicted to make room for another endpoint. */
+    uint32_t nEvictions = 0;
+  };
+
+  /**
+   * @param capacity maximum number of IPv6 endpoints, between 1 and @c MaxCapacity ;
+   *                 it is clamped into this range.
+   */
+  explicit UdpEndpointTable(size_t capacity = DefaultCapacity);
+
+  size_t capacity() const {
+    return m_capacity;
+  }
+
+  /**
+   * @brief Change capacity.
+   * @return whether success.
+   *
+   * All entries are erased. Previously assigned EndpointIds become invalid.
+   */
+  bool resize(size_t capacity);
+
+  /**
+   * @brief Find or insert an endpoint.
+   * @param addr IPv4 or IPv6 address.
+   * @param addrLen address length, either 4 or 16.
+   * @param port port number.
+   * @return EndpointId, or 0 if address length is invalid.
+   */
+  uint64_t encode(const uint8_t* addr, size_t addrLen, uint16_t port);
+
+  /**
+   * @brief Retrieve an endpoint.
+   * @param endpointId EndpointId returned by encode().
+   * @param[out] addr address buffer, at least 16 octets.
+   * @param[out] port port number.
+   * @return address length, or 0 if EndpointId is invalid or has been evicted.
+   */
+  size_t decode(uint64_t endpointId, uint8_t addr[16], uint16_t* port);
+
+  /** @brief Read counters. */
+  Counters readCounters() const {
+    return m_cnt;
+  }
+
+public:
+  enum {
+    DefaultCapacity = 16,
+    MaxCapacity = 0xFFFE,
+  };
+
+private:
+  struct Entry {
+    uint32_t gen; ///< generation number, 0 means unused
+    uint16_t hashNext;
+    uint16_t lruPrev;
+    uint16_t lruNext;
+    uint16_t port;
+    uint8_t addrLen;
+    uint8_t addr[16];
+  };
+
+  uint16_t& bucketOf(const uint8_t* addr, size_t addrLen, uint16_t port);
+
+  void lruUnlink(uint16_t index);
+
+  void lruPushFront(uint16_t index);
+
+  void evict(uint16_t index);
+
+private:
+  std::unique_ptr<Entry[]> m_entries;
+  std::unique_ptr<uint16_t[]> m_buckets;
+  size_t m_capacity = 0;
+  size_t m_nBuckets = 0;
+  size_t m_nUsed = 0;
+  uint16_t m_lruHead = 0xFFFF; ///< most recently used
+  uint16_t m_lruTail = 0xFFFF; ///< least recently used
+  uint32_t m_lastGen = 0;
+  Counters m_cnt;
+};
+
+} // namespace esp8266ndn
+
+#endif // ESP8266NDN_TRANSPORT_UDP_ENDPOINT_TABLE_HPP
@@ -1,12 +1,399 @@
-#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_RP2040)
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32) ||                                \
+  defined(ARDUINO_ARCH_RP2040) || defined(__linux__)
 
 #include "udp-transport.hpp"
 #include "../core/logger.hpp"
+#include "tlv-decode.hpp"
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+#define ESP8266NDN_UDP_LWIP_PCB
+#include "lwip-lock.hpp"
+
+#include <lwip/igmp.h>
+#include <lwip/pbuf.h>
+#include <lwip/udp.h>
+#endif
 
 #define LOG(...) LOGGER(UdpTransport, __VA_ARGS__)
 
 namespace esp8266ndn {
 
+namespace {
+
+using detail::LpHeaders;
+using detail::readTypeLength;
+using detail::skipLpHeaders;
+using detail::TtData;
+using detail::TtInterest;
+using detail::TtLpPacket;
+
+/** @brief Amount of received packets that may be processed in one loop. */
+class RxBudget {
+public:
+  explicit RxBudget(size_t maxPackets, size_t maxBytes)
+    : m_maxPackets(maxPackets)
+    , m_maxBytes(maxBytes) {}
+
+  explicit operator bool() const {
+    return (m_maxPackets == 0 || m_nPackets < m_maxPackets) &&
+           (m_maxBytes == 0 || m_nBytes < m_maxBytes);
+  }
+
+  void consume(size_t pktLen) {
+    ++m_nPackets;
+    m_nBytes += pktLen;
+  }
+
+private:
+  size_t m_maxPackets;
+  size_t m_maxBytes;
+  size_t m_nPackets = 0;
+  size_t m_nBytes = 0;
+};
+
+enum {
+  /** @brief Every Nth Interest in a tunnel group is sent to a non-preferred router. */
+  ExploreInterval = 16,
+  /** @brief An unhealthy router is retried after this many failover timeouts. */
+  RecoveryFactor = 8,
+};
+
+/** @brief Network layer information of a packet, possibly wrapped in NDNLPv2. */
+struct PacketInfo {
+  uint32_t type = 0; ///< network layer packet TLV-TYPE, 0 if unknown or not first fragment
+  bool isNack = false;
+  bool isFirstFragment = true; ///< true if the packet is unfragmented or the first fragment
+};
+
+PacketInfo
+classifyPacket(const uint8_t* pkt, size_t pktLen) {
+  PacketInfo info;
+  const uint8_t* pos = pkt;
+  const uint8_t* end = pkt + pktLen;
+  uint32_t type = 0, length = 0;
+  if (!readTypeLength(pos, end, type, length) || static_cast<size_t>(end - pos) < length) {
+    return info;
+  }
+  if (type != TtLpPacket) {
+    info.type = type;
+    return info;
+  }
+
+  end = pos + length;
+  LpHeaders lp;
+  if (!skipLpHeaders(pos, end, lp)) {
+    return info;
+  }
+  info.isNack = lp.isNack;
+  info.isFirstFragment = lp.isFirstFragment;
+  if (lp.isFirstFragment && pos < end) {
+    info.type = *pos;
+  }
+  return info;
+}
+
+} // anonymous namespace
+
+#ifdef ESP8266NDN_UDP_LWIP_PCB
+
+namespace {
+
+using detail::LwipLock;
+
+inline void
+toLwipAddr(const IPAddress& ip, ip_addr_t* addr) {
+#if defined(ARDUINO_ARCH_ESP8266)
+  ip_addr_copy(*addr, *static_cast<const ip_addr_t*>(ip));
+#elif defined(ARDUINO_ARCH_ESP32)
+  ip.to_ip_addr_t(addr);
+#endif
+}
+
+inline IPAddress
+fromLwipAddr(const ip_addr_t* addr) {
+#if defined(ARDUINO_ARCH_ESP8266)
+  return IPAddress(addr);
+#elif defined(ARDUINO_ARCH_ESP32)
+  IPAddress ip;
+  ip.from_ip_addr_t(addr);
+  return ip;
+#endif
+}
+
+} // anonymous namespace
+
+class UdpTransport::LwipPcb {
+public:
+  /**
+   * @brief Received datagram.
+   *
+   * If @c p is not nullptr, the datagram is retained in lwIP pbuf.
+   * Otherwise, the datagram has been copied into RX queue buffer @c buf .
+   */
+  struct RxItem {
+    pbuf* p;
+    uint8_t* buf;
+    uint16_t len;
+    uint16_t port;
+    ip_addr_t addr;
+  };
+
+  /** @brief Received datagram accepted by UdpTransport, waiting to be dispatched. */
+  struct Pending {
+    RxItem item;
+    uint64_t endpointId;
+  };
+
+  explicit LwipPcb(LwipCounters& cnt)
+    : m_cnt(cnt) {}
+
+  ~LwipPcb() {
+    close();
+  }
+
+  /**
+   * @brief Allocate RX queue buffers.
+   * @pre PCB is closed.
+   */
+  bool setRxQueue(size_t capacity, size_t bufLen) {
+    for (bool ok = true; ok;) {
+      std::tie(std::ignore, ok) = m_freeBufs.pop();
+    }
+    m_bufs.reset();
+    m_bufLen = 0;
+
+    if (capacity == 0) {
+      return true;
+    }
+    if (capacity > LwipPcbRxCapacity) {
+      return false;
+    }
+
+    m_bufs.reset(new uint8_t[capacity * bufLen]);
+    for (size_t i = 0; i < capacity; ++i) {
+      m_freeBufs.push(&m_bufs[i * bufLen]);
+    }
+    m_bufLen = bufLen;
+    return true;
+  }
+
+  /**
+   * @brief Create and bind the PCB.
+   * @param localIp local address, or nullptr to bind to any address.
+   */
+  bool begin(const IPAddress* localIp, uint16_t localPort) {
+    ip_addr_t addr;
+    if (localIp != nullptr) {
+      toLwipAddr(*localIp, &addr);
+    }
+
+    err_t e = ERR_OK;
+    {
+      LwipLock lock;
+      m_pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+      if (m_pcb == nullptr) {
+        e = ERR_MEM;
+      } else {
+        e = udp_bind(m_pcb, localIp == nullptr ? IP_ANY_TYPE : &addr, localPort);
+        if (e == ERR_OK) {
+          udp_recv(m_pcb, LwipPcb::recv, this);
+        } else {
+          udp_remove(m_pcb);
+          m_pcb = nullptr;
+        }
+      }
+    }
+
+    if (e != ERR_OK) {
+      LOG(F("udp_bind error ") << _DEC(e));
+      return false;
+    }
+    return true;
+  }
+
+  /** @brief Join an IPv4 multicast group, and send multicast packets on the same interface. */
+  bool joinGroup(const IPAddress& localIp, const IPAddress& group) {
+    ip4_addr_set_u32(&m_ifaddr, static_cast<uint32_t>(localIp));
+    ip4_addr_set_u32(&m_group, static_cast<uint32_t>(group));
+
+    err_t e = ERR_OK;
+    {
+      LwipLock lock;
+      e = igmp_joingroup(&m_ifaddr, &m_group);
+#if LWIP_MULTICAST_TX_OPTIONS
+      if (e == ERR_OK) {
+        udp_set_multicast_netif_addr(m_pcb, &m_ifaddr);
+      }
+#endif
+    }
+
+    if (e != ERR_OK) {
+      LOG(F("igmp_joingroup error ") << _DEC(e));
+      return false;
+    }
+    m_hasGroup = true;
+    return true;
+  }
+
+  /** @brief Leave multicast group, delete the PCB, and release retained pbufs. */
+  void close() {
+    if (m_pcb == nullptr) {
+      return;
+    }
+
+    {
+      LwipLock lock;
+      if (m_hasGroup) {
+        igmp_leavegroup(&m_ifaddr, &m_group);
+      }
+      udp_remove(m_pcb);
+    }
+    m_pcb = nullptr;
+    m_hasGroup = false;
+
+    RxItem item;
+    while (pop(item)) {
+      release(item);
+    }
+    if (!dispatching) {
+      for (size_t i = 0; i < nPending; ++i) {
+        release(pending[i].item);
+      }
+      nPending = 0;
+    }
+  }
+
+  TxResult send(const uint8_t* pkt, size_t pktLen, const IPAddress& ip, uint16_t port) {
+    ip_addr_t addr;
+    toLwipAddr(ip, &addr);
+
+    err_t e = ERR_OK;
+    {
+      LwipLock lock;
+      pbuf* p = pbuf_alloc(PBUF_TRANSPORT, pktLen, PBUF_RAM);
+      if (p == nullptr) {
+        e = ERR_MEM;
+      } else {
+        pbuf_take(p, pkt, pktLen);
+        e = udp_sendto(m_pcb, p, &addr, port);
+        pbuf_free(p);
+      }
+    }
+
+    switch (e) {
+      case ERR_OK:
+        return TxResult::OK;
+      case ERR_MEM:
+      case ERR_BUF:
+      case ERR_WOULDBLOCK:
+        return TxResult::Retry;
+      default:
+        LOG(F("udp_sendto error ") << _DEC(e));
+        return TxResult::Fail;
+    }
+  }
+
+  /** @brief Retrieve a received datagram; caller must release it. */
+  bool pop(RxItem& item) {
+    bool ok = false;
+    std::tie(item, ok) = m_rxQueue.pop();
+    m_nPopped += ok;
+    return ok;
+  }
+
+  /** @brief Return number of datagrams in the RX queue, possibly overestimated by one. */
+  size_t queued() const {
+    return m_nPushed.load(std::memory_order_relaxed) - m_nPopped;
+  }
+
+  void release(const RxItem& item) {
+    if (item.p == nullptr) {
+      m_freeBufs.push(item.buf);
+      return;
+    }
+    LwipLock lock;
+    pbuf_free(item.p);
+  }
+
+private:
+  /** @brief Increment a counter that has a single writer, without atomic read-modify-write. */
+  static void increment(std::atomic<uint32_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  static void recv(void* arg, udp_pcb*, pbuf* p, const ip_addr_t* addr, u16_t port) {
+    LwipPcb& self = *static_cast<LwipPcb*>(arg);
+    RxItem item{};
+    item.p = p;
+    item.len = p->tot_len;
+    item.port = port;
+    ip_addr_copy(item.addr, *addr);
+
+    if (self.m_bufLen > 0) {
+      if (item.len > self.m_bufLen) {
+        increment(self.m_cnt.nRxOversize);
+        pbuf_free(p);
+        return;
+      }
+      bool ok = false;
+      std::tie(item.buf, ok) = self.m_freeBufs.pop();
+      if (!ok) {
+        increment(self.m_cnt.nRxQueueFull);
+        pbuf_free(p);
+        return;
+      }
+      pbuf_copy_partial(p, item.buf, item.len, 0);
+      pbuf_free(p);
+      item.p = nullptr;
+    }
+
+    // count before pushing, so that queued() never sees more pops than pushes
+    increment(self.m_nPushed);
+    if (!self.m_rxQueue.push(item)) {
+      self.m_nPushed.store(self.m_nPushed.load(std::memory_order_relaxed) - 1,
+                           std::memory_order_relaxed);
+      increment(self.m_cnt.nRxQueueFull);
+      if (item.p == nullptr) {
+        self.m_freeBufs.push(item.buf);
+      } else {
+        pbuf_free(p);
+      }
+    }
+  }
+
+public:
+  /**
+   * @brief Datagrams retrieved from RX queue but not yet dispatched.
+   *
+   * They are kept in arrival order.
+   */
+  Pending pending[LwipPcbRxCapacity];
+  size_t nPending = 0;
+  /** @brief Number of endpoints served, used to rotate the starting endpoint of each round. */
+  size_t rotate = 0;
+  /** @brief Whether UdpTransport is iterating @c pending . */
+  bool dispatching = false;
+
+private:
+  LwipCounters& m_cnt;
+  udp_pcb* m_pcb = nullptr;
+  ndnph::port::SafeQueue<RxItem, LwipPcbRxCapacity> m_rxQueue;
+  std::atomic<uint32_t> m_nPushed{0}; ///< written by the lwIP thread only
+  uint32_t m_nPopped = 0;
+  ndnph::port::SafeQueue<uint8_t*, LwipPcbRxCapacity> m_freeBufs;
+  std::unique_ptr<uint8_t[]> m_bufs;
+  size_t m_bufLen = 0;
+  ip4_addr_t m_ifaddr;
+  ip4_addr_t m_group;
+  bool m_hasGroup = false;
+};
+
+#else
+
+class UdpTransport::LwipPcb {};
+
+#endif // ESP8266NDN_UDP_LWIP_PCB
+
 const IPAddress UdpTransport::MulticastGroup(224, 0, 23, 170);
 
 UdpTransport::UdpTransport(size_t mtu) {
@@ -19,21 +406,101 @@ UdpTransport::UdpTransport(uint8_t* buffer, size_t capacity)
   : m_buf(buffer)
   , m_bufcap(capacity) {}
 
+UdpTransport::~UdpTransport() {
+  end();
+}
+
+bool
+UdpTransport::setBackend(Backend backend) {
+  if (m_mode != Mode::NONE) {
+    LOG(F("cannot change backend while active"));
+    return false;
+  }
+
+  switch (backend) {
+    case Backend::NetworkUdp:
+      m_pcb.reset();
+      return true;
+    case Backend::LwipPcb:
+#ifdef ESP8266NDN_UDP_LWIP_PCB
+      if (m_pcb == nullptr) {
+        m_pcb.reset(new LwipPcb(m_lwipCnt));
+      }
+      return true;
+#else
+      LOG(F("LwipPcb backend unavailable"));
+      return false;
+#endif
+  }
+  return false;
+}
+
+bool
+UdpTransport::setRxQueue(size_t capacity) {
+  if (m_mode != Mode::NONE) {
+    LOG(F("cannot change RX queue while active"));
+    return false;
+  }
+
+#ifdef ESP8266NDN_UDP_LWIP_PCB
+  if (m_pcb != nullptr) {
+    return m_pcb->setRxQueue(capacity, m_bufcap);
+  }
+#endif
+  LOG(F("RX queue requires LwipPcb backend"));
+  return false;
+}
+
+void
+UdpTransport::setRxBudget(size_t maxPackets, size_t maxBytes) {
+  m_rxBudgetPackets = maxPackets;
+  m_rxBudgetBytes = maxBytes;
+}
+
+bool
+UdpTransport::setTxQueue(size_t capacity) {
+  if (m_mode != Mode::NONE) {
+    LOG(F("cannot change TX queue while active"));
+    return false;
+  }
+  return m_txQueue.resize(capacity, m_bufcap);
+}
+
+bool
+UdpTransport::setEndpointCapacity(size_t capacity) {
+  if (m_mode != Mode::NONE) {
+    LOG(F("cannot change endpoint capacity while active"));
+    return false;
+  }
+  return m_endpoints.resize(capacity);
+}
+
 bool
 UdpTransport::beginListen(uint16_t localPort, IPAddress localIp) {
   end();
-#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_RP2040)
+  bool ok = false;
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_RP2040) || defined(__linux__)
 #if LWIP_IPV6
   LOG(F("listening on [::]:") << _DEC(localPort));
 #else
   LOG(F("listening on 0.0.0.0:") << _DEC(localPort));
 #endif
-  bool ok = m_udp.begin(localPort);
+#ifdef ESP8266NDN_UDP_LWIP_PCB
+  if (m_pcb != nullptr) {
+    ok = m_pcb->begin(nullptr, localPort);
+  } else
+#endif
+  {
+    ok = m_udp.begin(localPort);
+  }
 #elif defined(ARDUINO_ARCH_ESP32)
   LOG(F("listening on ") << localIp << ':' << _DEC(localPort));
-  bool ok = localIp.type() == IPType::IPv4 && uint32_t(localIp) == 0
-              ? m_udp.begin(localPort)
-              : m_udp.begin(localIp, localPort);
+  bool isAny = localIp.type() == IPType::IPv4 && uint32_t(localIp) == 0;
+  if (m_pcb != nullptr) {
+    ok = m_pcb->begin(isAny ? nullptr : &localIp, localPort);
+  } else {
+    ok = isAny ? m_udp.begin(localPort) : m_udp.begin(localIp, localPort);
+  }
 #endif
   if (ok) {
     m_mode = Mode::LISTEN;
@@ -43,17 +510,54 @@ UdpTransport::beginListen(uint16_t localPort, IPAddress localIp) {
 
 bool
 UdpTransport::beginTunnel(IPAddress remoteIp, uint16_t remotePort, uint16_t localPort) {
+  return beginTunnel(&remoteIp, 1, remotePort, localPort);
+}
+
+bool
+UdpTransport::beginTunnel(const IPAddress* remoteIps, size_t count, uint16_t remotePort,
+                          uint16_t localPort) {
   end();
-  LOG(F("connecting to ") << remoteIp << ':' << remotePort << F(" from :") << _DEC(localPort));
-  bool ok =
+  if (count == 0 || count > MaxTunnelRouters) {
+    LOG(F("router count must be between 1 and ") << _DEC(MaxTunnelRouters));
+    return false;
+  }
 #if defined(ARDUINO_ARCH_ESP32) && LWIP_IPV6
-    remoteIp.type() == IPType::IPv6 ? m_udp.begin(IN6ADDR_ANY, localPort) :
+  bool hasV6 = false;
 #endif
-                                    m_udp.begin(localPort);
+  for (size_t i = 0; i < count; ++i) {
+    LOG(F("connecting to ") << remoteIps[i] << ':' << remotePort << F(" from :")
+                            << _DEC(localPort));
+#if defined(ARDUINO_ARCH_ESP32) && LWIP_IPV6
+    hasV6 = hasV6 || remoteIps[i].type() == IPType::IPv6;
+#endif
+  }
+
+  bool ok = false;
+#ifdef ESP8266NDN_UDP_LWIP_PCB
+  if (m_pcb != nullptr) {
+    ok = m_pcb->begin(nullptr, localPort);
+  } else
+#endif
+  {
+    ok =
+#if defined(ARDUINO_ARCH_ESP32) && LWIP_IPV6
+      hasV6 ? m_udp.begin(IN6ADDR_ANY, localPort) :
+#endif
+            m_udp.begin(localPort);
+  }
   if (ok) {
     m_mode = Mode::TUNNEL;
-    m_ip = remoteIp;
     m_port = remotePort;
+    m_pathMtu = DefaultMtu;
+    for (size_t i = 0; i < count; ++i) {
+      m_routers[i] = TunnelRouter();
+      m_routers[i].ip = remoteIps[i];
+    }
+    m_nRouters = count;
+    m_activeRouter = 0;
+    m_exploreRouter = 0;
+    m_txRouter = 0;
+    m_nTunnelInterests = 0;
   }
   return ok;
 }
@@ -61,13 +565,28 @@ UdpTransport::beginTunnel(IPAddress remoteIp, uint16_t remotePort, uint16_t loca
 bool
 UdpTransport::beginMulticast(IPAddress localIp, uint16_t groupPort) {
   end();
-#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_RP2040)
+  bool ok = false;
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_RP2040) || defined(__linux__)
   LOG(F("joining group ") << MulticastGroup << ':' << _DEC(groupPort) << F(" on ") << localIp);
-  bool ok = m_udp.beginMulticast(localIp, MulticastGroup, groupPort);
 #elif defined(ARDUINO_ARCH_ESP32)
   LOG(F("joining group ") << MulticastGroup << ':' << _DEC(groupPort));
-  bool ok = m_udp.beginMulticast(MulticastGroup, groupPort);
 #endif
+#ifdef ESP8266NDN_UDP_LWIP_PCB
+  if (m_pcb != nullptr) {
+    ok = m_pcb->begin(nullptr, groupPort);
+    if (ok && !m_pcb->joinGroup(localIp, MulticastGroup)) {
+      m_pcb->close();
+      ok = false;
+    }
+  } else
+#endif
+  {
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_RP2040) || defined(__linux__)
+    ok = m_udp.beginMulticast(localIp, MulticastGroup, groupPort);
+#elif defined(ARDUINO_ARCH_ESP32)
+    ok = m_udp.beginMulticast(MulticastGroup, groupPort);
+#endif
+  }
   if (ok) {
     m_mode = Mode::MULTICAST;
     m_ip = localIp;
@@ -81,7 +600,15 @@ UdpTransport::end() {
   m_mode = Mode::NONE;
   m_ip = INADDR_NONE;
   m_port = 0;
+  m_nRouters = 0;
+  m_txQueue.clear();
   m_udp.stop();
+  m_rxParsedLen = 0;
+#ifdef ESP8266NDN_UDP_LWIP_PCB
+  if (m_pcb != nullptr) {
+    m_pcb->close();
+  }
+#endif
 }
 
 bool
@@ -94,43 +621,87 @@ UdpTransport::doLoop() {
   if (m_mode == Mode::NONE) {
     return;
   }
-  for (int pktLen = m_udp.parsePacket(); pktLen > 0; pktLen = m_udp.parsePacket()) {
-    uint64_t endpointId = 0;
-    if (m_mode == Mode::TUNNEL) {
-      if (m_udp.remoteIP() != m_ip || m_udp.remotePort() != m_port) {
-#if defined(ARDUINO_ARCH_ESP8266)
-        m_udp.flush();
-#elif defined(ARDUINO_ARCH_ESP32)
-        m_udp.clear();
+  if (m_mode == Mode::TUNNEL) {
+    checkTunnel();
+  }
+  loopTxQueue();
+#ifdef ESP8266NDN_UDP_LWIP_PCB
+  if (m_pcb != nullptr) {
+    loopRxQueue();
+    return;
+  }
 #endif
-        continue;
+  loopNetworkUdp();
+}
+
+bool
+UdpTransport::acceptRemote(const IPAddress& ip, uint16_t port, uint64_t& endpointId) {
+  endpointId = 0;
+  if (m_mode == Mode::TUNNEL) {
+    if (port != m_port) {
+      return false;
+    }
+    for (size_t i = 0; i < m_nRouters; ++i) {
+      if (ip == m_routers[i].ip) {
+        endpointId = m_nRouters > 1 ? i + 1 : 0;
+        return true;
       }
-    } else {
-      IPAddress ip = m_udp.remoteIP();
-      uint16_t port = m_udp.remotePort();
+    }
+    return false;
+  }
+
 #if LWIP_IPV6
 #if defined(ARDUINO_ARCH_ESP8266)
-      if (ip.isV6()) {
-        endpointId = m_endpoints.encode(reinterpret_cast<const uint8_t*>(ip.raw6()), 16, port);
-      } else
+  if (ip.isV6()) {
+    endpointId = m_endpoints.encode(reinterpret_cast<const uint8_t*>(ip.raw6()), 16, port);
+  } else
 #elif defined(ARDUINO_ARCH_ESP32)
-      if (ip.type() == IPType::IPv6) {
-        uint8_t addr[16];
-        for (int i = 0; i < 16; ++i) {
-          addr[i] = ip[i];
-        }
-        endpointId = m_endpoints.encode(addr, 16, port);
-      } else
+  if (ip.type() == IPType::IPv6) {
+    uint8_t addr[16];
+    for (int i = 0; i < 16; ++i) {
+      addr[i] = ip[i];
+    }
+    endpointId = m_endpoints.encode(addr, 16, port);
+  } else
 #endif
 #endif
-      {
-        uint32_t ip4 = ip;
-        endpointId = m_endpoints.encode(reinterpret_cast<const uint8_t*>(&ip4), 4, port);
-      }
+  {
+    uint32_t ip4 = ip;
+    endpointId = m_endpoints.encode(reinterpret_cast<const uint8_t*>(&ip4), 4, port);
+  }
+  return true;
+}
+
+void
+UdpTransport::loopNetworkUdp() {
+  RxBudget budget(m_rxBudgetPackets, m_rxBudgetBytes);
+  while (true) {
+    // a datagram parsed when the previous loop ran out of budget is still in m_udp
+    int pktLen = m_rxParsedLen > 0 ? m_rxParsedLen : m_udp.parsePacket();
+    m_rxParsedLen = 0;
+    if (pktLen <= 0) {
+      return;
+    }
+    if (!budget) {
+      m_rxParsedLen = pktLen;
+      ++m_cnt.nRxDeferred;
+      return;
+    }
+    budget.consume(pktLen);
+
+    uint64_t endpointId = 0;
+    if (!acceptRemote(m_udp.remoteIP(), m_udp.remotePort(), endpointId)) {
+#if defined(ARDUINO_ARCH_ESP8266)
+      m_udp.flush();
+#elif defined(ARDUINO_ARCH_ESP32)
+      m_udp.clear();
+#endif
+      continue;
     }
 
     if (static_cast<size_t>(pktLen) > m_bufcap) {
       LOG(F("packet longer than buffer capacity pktLen=") << pktLen);
+      ++m_cnt.nRxOversize;
       continue;
     }
 
@@ -143,71 +714,417 @@ UdpTransport::doLoop() {
     if (len <= 0) {
       continue;
     }
-    invokeRxCallback(m_buf, pktLen, endpointId);
+    receive(m_buf, pktLen, endpointId);
+  }
+}
+
+void
+UdpTransport::loopRxQueue() {
+#ifdef ESP8266NDN_UDP_LWIP_PCB
+  static_assert(LwipPcbRxCapacity <= 32, "");
+  RxBudget budget(m_rxBudgetPackets, m_rxBudgetBytes);
+  LwipPcb& pcb = *m_pcb;
+  while (budget) {
+    // move newly arrived datagrams into pending list
+    LwipPcb::RxItem item;
+    while (pcb.nPending < LwipPcbRxCapacity && budget && pcb.pop(item)) {
+      uint64_t endpointId = 0;
+      if (!acceptRemote(fromLwipAddr(&item.addr), item.port, endpointId)) {
+        budget.consume(item.len);
+        pcb.release(item);
+      } else if (item.p != nullptr && item.len > m_bufcap) {
+        LOG(F("packet longer than buffer capacity pktLen=") << item.len);
+        ++m_cnt.nRxOversize;
+        budget.consume(item.len);
+        pcb.release(item);
+      } else {
+        pcb.pending[pcb.nPending++] = {item, endpointId};
+      }
+    }
+    if (pcb.nPending == 0) {
+      return;
+    }
+
+    // in each round, dispatch the oldest datagram of each remote endpoint
+    uint8_t firstPos[LwipPcbRxCapacity];
+    size_t nFirst = 0;
+    for (size_t i = 0; i < pcb.nPending; ++i) {
+      bool isFirst = true;
+      for (size_t j = 0; j < i; ++j) {
+        if (pcb.pending[j].endpointId == pcb.pending[i].endpointId) {
+          isFirst = false;
+          break;
+        }
+      }
+      if (isFirst) {
+        firstPos[nFirst++] = static_cast<uint8_t>(i);
+      }
+    }
+
+    // if the budget cannot serve every endpoint, start from where the previous round stopped,
+    // so that endpoints whose datagrams arrived first do not always win
+    uint32_t isSelected = 0;
+    RxBudget trial = budget;
+    size_t k = 0;
+    for (; k < nFirst && trial; ++k) {
+      size_t i = firstPos[(pcb.rotate + k) % nFirst];
+      isSelected |= 1U << i;
+      trial.consume(pcb.pending[i].item.len);
+    }
+    pcb.rotate += k;
+
+    size_t nKept = 0;
+    pcb.dispatching = true;
+    for (size_t i = 0, n = pcb.nPending; i < n; ++i) {
+      LwipPcb::Pending cur = pcb.pending[i];
+      if (m_mode == Mode::NONE) {
+        pcb.release(cur.item);
+        continue;
+      }
+      if ((isSelected & (1U << i)) == 0) {
+        pcb.pending[nKept++] = cur;
+        continue;
+      }
+
+      budget.consume(cur.item.len);
+      pbuf* p = cur.item.p;
+      if (p == nullptr) {
+        receive(cur.item.buf, cur.item.len, cur.endpointId);
+      } else if (p->next == nullptr) {
+        receive(static_cast<const uint8_t*>(p->payload), p->len, cur.endpointId);
+      } else {
+        pbuf_copy_partial(p, m_buf, cur.item.len, 0);
+        receive(m_buf, cur.item.len, cur.endpointId);
+      }
+      pcb.release(cur.item);
+    }
+    pcb.dispatching = false;
+    pcb.nPending = nKept;
+
+    if (m_mode == Mode::NONE) {
+      // transport was disabled during dispatching
+      for (size_t i = 0; i < pcb.nPending; ++i) {
+        pcb.release(pcb.pending[i].item);
+      }
+      pcb.nPending = 0;
+      return;
+    }
   }
+  m_cnt.nRxDeferred += pcb.nPending + pcb.queued();
+#endif
+}
+
+void
+UdpTransport::receive(const uint8_t* pkt, size_t pktLen, uint64_t endpointId) {
+  if (m_mode == Mode::TUNNEL) {
+    PacketInfo info = classifyPacket(pkt, pktLen);
+    if (info.type == TtData || info.isNack) {
+      rxTunnel(endpointId == 0 ? 0 : endpointId - 1);
+    }
+  }
+  ++m_cnt.nRxServiced;
+  invokeRxCallback(pkt, pktLen, endpointId);
 }
 
 bool
-UdpTransport::doSend(const uint8_t* pkt, size_t pktLen, uint64_t endpointId) {
-  bool ok = false;
+UdpTransport::resolveRemote(uint64_t endpointId, IPAddress& ip, uint16_t& port) {
   if (endpointId == 0) {
     switch (m_mode) {
       case Mode::LISTEN:
         LOG(F("remote endpoint not specified"));
         return false;
       case Mode::TUNNEL:
-        ok = m_udp.beginPacket(m_ip, m_port);
-        break;
+        ip = m_routers[m_activeRouter].ip;
+        port = m_port;
+        return true;
       case Mode::MULTICAST:
-#if defined(ARDUINO_ARCH_ESP8266)
-        ok = m_udp.beginPacketMulticast(MulticastGroup, m_port, m_ip);
-#elif defined(ARDUINO_ARCH_ESP32)
-        ok = m_udp.beginMulticastPacket();
-#elif defined(ARDUINO_ARCH_RP2040)
-        ok = m_udp.beginPacketMulticast(MulticastGroup, m_port, m_ip);
-#endif
-        break;
+        ip = MulticastGroup;
+        port = m_port;
+        return true;
       case Mode::NONE:
         return false;
     }
-  } else if (m_mode == Mode::NONE) {
     return false;
-  } else {
-    uint8_t addr[16];
-    uint16_t port = 0;
-    size_t addrLen = m_endpoints.decode(endpointId, addr, &port);
-    IPAddress ip;
-    switch (addrLen) {
-      case 4:
-        ip = addr;
-        break;
+  }
+
+  switch (m_mode) {
+    case Mode::NONE:
+      return false;
+    case Mode::TUNNEL:
+      if (endpointId > m_nRouters) {
+        return false;
+      }
+      ip = m_routers[endpointId - 1].ip;
+      port = m_port;
+      return true;
+    default:
+      break;
+  }
+
+  uint8_t addr[16];
+  size_t addrLen = m_endpoints.decode(endpointId, addr, &port);
+  switch (addrLen) {
+    case 4:
+      ip = addr;
+      return true;
 #if LWIP_IPV6
-      case 16:
+    case 16:
 #if defined(ARDUINO_ARCH_ESP8266)
-        std::copy_n(addr, addrLen, reinterpret_cast<uint8_t*>(ip.raw6()));
+      std::copy_n(addr, addrLen, reinterpret_cast<uint8_t*>(ip.raw6()));
 #elif defined(ARDUINO_ARCH_ESP32)
-        ip = IPAddress(IPType::IPv6, addr);
+      ip = IPAddress(IPType::IPv6, addr);
 #endif
-        break;
+      return true;
 #endif
-      default:
+    default:
+      return false;
+  }
+}
+
+size_t
+UdpTransport::txTunnelInterest() {
+  checkTunnel();
+
+  size_t index = m_activeRouter;
+  if (m_nRouters > 1 && ++m_nTunnelInterests % ExploreInterval == 0) {
+    for (size_t i = 1; i <= m_nRouters; ++i) {
+      size_t j = (m_exploreRouter + i) % m_nRouters;
+      if (j != m_activeRouter && !m_routers[j].isDown) {
+        index = m_exploreRouter = j;
+        break;
+      }
+    }
+  }
+
+  TunnelRouter& router = m_routers[index];
+  if (!router.hasPending) {
+    router.hasPending = true;
+    router.pendingSince = ndnph::port::Clock::now();
+  }
+  return index;
+}
+
+void
+UdpTransport::rxTunnel(size_t index) {
+  TunnelRouter& router = m_routers[index];
+  if (router.hasPending) {
+    // time between the oldest unanswered Interest and the first reply; this overestimates RTT
+    // if that Interest was lost, which is smoothed out over subsequent samples
+    int sample = ndnph::port::Clock::sub(ndnph::port::Clock::now(), router.pendingSince);
+    router.srtt = router.srtt < 0 ? sample : (7 * router.srtt + sample) / 8;
+    router.hasPending = false;
+  }
+  router.isDown = false;
+  selectRouter();
+}
+
+void
+UdpTransport::checkTunnel() {
+  auto now = ndnph::port::Clock::now();
+  for (size_t i = 0; i < m_nRouters; ++i) {
+    TunnelRouter& router = m_routers[i];
+    if (router.hasPending &&
+        ndnph::port::Clock::sub(now, router.pendingSince) > m_failoverTimeout) {
+      LOG(F("router ") << router.ip << F(" unresponsive"));
+      router.hasPending = false;
+      router.isDown = true;
+      router.downSince = now;
+    } else if (router.isDown &&
+               ndnph::port::Clock::sub(now, router.downSince) >
+                 RecoveryFactor * m_failoverTimeout) {
+      // give it another chance: its RTT is re-measured when it is explored
+      router.isDown = false;
+      router.srtt = -1;
+    }
+  }
+
+  if (m_routers[m_activeRouter].isDown) {
+    selectRouter();
+  }
+}
+
+void
+UdpTransport::selectRouter() {
+  bool wasDown = m_routers[m_activeRouter].isDown;
+  int best = wasDown ? -1 : m_activeRouter;
+  for (size_t i = 0; i < m_nRouters; ++i) {
+    const TunnelRouter& router = m_routers[i];
+    if (router.isDown || router.srtt < 0) {
+      continue;
+    }
+    if (best < 0 || m_routers[best].srtt < 0 ||
+        // hysteresis: switch away from a healthy router only if significantly faster
+        router.srtt * 8 < m_routers[best].srtt * (best == m_activeRouter ? 7 : 8)) {
+      best = i;
+    }
+  }
+
+  if (best < 0) {
+    // no router with known RTT is healthy: try the next healthy router, or every router if
+    // all are unhealthy
+    for (size_t i = 1; i <= m_nRouters && best < 0; ++i) {
+      size_t j = (m_activeRouter + i) % m_nRouters;
+      if (!m_routers[j].isDown) {
+        best = j;
+      }
+    }
+    if (best < 0) {
+      for (size_t i = 0; i < m_nRouters; ++i) {
+        m_routers[i].isDown = false;
+      }
+      best = (m_activeRouter + 1) % m_nRouters;
+    }
+  }
+
+  if (static_cast<size_t>(best) == m_activeRouter) {
+    return;
+  }
+  if (wasDown) {
+    ++m_cnt.nFailovers;
+  }
+  m_activeRouter = best;
+  LOG(F("preferred router ") << m_routers[best].ip);
+}
+
+bool
+UdpTransport::doSend(const uint8_t* pkt, size_t pktLen, uint64_t endpointId) {
+  return sendPacket(pkt, pktLen, endpointId, true);
+}
+
+bool
+UdpTransport::sendPacket(const uint8_t* pkt, size_t pktLen, uint64_t endpointId,
+                         bool canFragment) {
+  if (m_mode == Mode::TUNNEL && endpointId == 0) {
+    // choose a router for each network layer packet, and send all its fragments to that router
+    PacketInfo info = classifyPacket(pkt, pktLen);
+    if (info.isFirstFragment) {
+      m_txRouter = info.type == TtInterest && !info.isNack ? txTunnelInterest() : m_activeRouter;
+    }
+    endpointId = 1 + m_txRouter;
+  }
+
+  if (!canFragment || m_mode != Mode::TUNNEL || pktLen <= m_pathMtu) {
+    return sendFrame(pkt, pktLen, endpointId);
+  }
+
+  if (m_fragmenterMtu < m_pathMtu) {
+    m_fragmenter.reset(new LpFragmenter(m_pathMtu));
+    m_fragmenterMtu = m_pathMtu;
+  }
+  if (m_fragmenter->begin(pkt, pktLen, m_pathMtu) == 0) {
+    LOG(F("cannot fragment packet pktLen=") << pktLen);
+    return false;
+  }
+  bool ok = true;
+  const uint8_t* frame = nullptr;
+  for (size_t frameLen = 0; (frameLen = m_fragmenter->next(frame)) > 0;) {
+    ok = sendFrame(frame, frameLen, endpointId) && ok;
+  }
+  return ok;
+}
+
+bool
+UdpTransport::sendFrame(const uint8_t* pkt, size_t pktLen, uint64_t endpointId) {
+  if (m_txQueue.capacity() == 0 || pktLen > m_bufcap) {
+    // packet longer than a TX queue slot cannot be queued, so it is attempted once
+    return transmit(pkt, pktLen, endpointId) == TxResult::OK;
+  }
+
+  if (m_txQueue.size() == 0 && m_txQueue.take(ndnph::port::Clock::now())) {
+    switch (transmit(pkt, pktLen, endpointId)) {
+      case TxResult::OK:
+        return true;
+      case TxResult::Fail:
         return false;
+      case TxResult::Retry:
+        ++m_cnt.nTxRetries;
+        break;
+    }
+  }
+
+  if (!m_txQueue.push(pkt, pktLen, endpointId)) {
+    LOG(F("TX queue full, dropping packet"));
+    ++m_cnt.nTxDropped;
+    return false;
+  }
+  return true;
+}
+
+void
+UdpTransport::loopTxQueue() {
+  auto now = ndnph::port::Clock::now();
+  while (auto item = m_txQueue.front()) {
+    if (!m_txQueue.take(now)) {
+      break;
     }
+    switch (transmit(item->pkt, item->pktLen, item->endpointId)) {
+      case TxResult::OK:
+        m_txQueue.pop();
+        continue;
+      case TxResult::Fail:
+        // destination became invalid, such as an evicted EndpointId
+        ++m_cnt.nTxDropped;
+        m_txQueue.pop();
+        continue;
+      case TxResult::Retry:
+        break;
+    }
+
+    if (++item->nRetries > MaxTxRetries) {
+      ++m_cnt.nTxDropped;
+      m_txQueue.pop();
+    } else {
+      ++m_cnt.nTxRetries;
+    }
+    // network stack is short of buffers, try again in next loop
+    break;
+  }
+}
+
+UdpTransport::TxResult
+UdpTransport::transmit(const uint8_t* pkt, size_t pktLen, uint64_t endpointId) {
+  IPAddress ip;
+  uint16_t port = 0;
+  if (!resolveRemote(endpointId, ip, port)) {
+    return TxResult::Fail;
+  }
+  if (pktLen > MaxUdpPayload) {
+    LOG(F("packet longer than UDP payload limit pktLen=") << pktLen);
+    return TxResult::Fail;
+  }
+
+#ifdef ESP8266NDN_UDP_LWIP_PCB
+  if (m_pcb != nullptr) {
+    return m_pcb->send(pkt, pktLen, ip, port);
+  }
+#endif
+
+  // WiFiUDP and NetworkUDP failures are mostly due to buffer allocation, which may recover
+  bool ok = false;
+  if (endpointId == 0 && m_mode == Mode::MULTICAST) {
+#if defined(ARDUINO_ARCH_ESP8266)
+    ok = m_udp.beginPacketMulticast(MulticastGroup, m_port, m_ip);
+#elif defined(ARDUINO_ARCH_ESP32)
+    ok = m_udp.beginMulticastPacket();
+#elif defined(ARDUINO_ARCH_RP2040) || defined(__linux__)
+    ok = m_udp.beginPacketMulticast(MulticastGroup, m_port, m_ip);
+#endif
+  } else {
     ok = m_udp.beginPacket(ip, port);
   }
 
   if (!ok) {
     LOG(F("Udp::beginPacket error"));
-    return false;
+    return TxResult::Retry;
   }
 
   m_udp.write(pkt, pktLen);
   if (!m_udp.endPacket()) {
     LOG(F("Udp::endPacket error"));
-    return false;
+    return TxResult::Retry;
   }
 
-  return true;
+  return TxResult::OK;
 }
 
 } // namespace esp8266ndn
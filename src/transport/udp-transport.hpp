@@ -1,11 +1,17 @@
 #ifndef ESP8266NDN_TRANSPORT_UDP_TRANSPORT_HPP
 #define ESP8266NDN_TRANSPORT_UDP_TRANSPORT_HPP
 
-#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_RP2040)
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32) ||                                \
+  defined(ARDUINO_ARCH_RP2040) || defined(__linux__)
 
 #include "../port/port.hpp"
+#include "lp-fragmentation.hpp"
+#include "udp-endpoint-table.hpp"
+#include "udp-tx-queue.hpp"
 
-#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_RP2040)
+#include <atomic>
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_RP2040) || defined(__linux__)
 #include <WiFiUdp.h>
 #define ESP8266NDN_NetworkUDP WiFiUDP
 #elif defined(ARDUINO_ARCH_ESP32)
@@ -40,12 +46,16 @@ public:
   explicit UdpTransport(std::array<uint8_t, capacity>& buffer)
     : UdpTransport(buffer.data(), buffer.size()) {}
 
+  ~UdpTransport() override;
+
   /**
    * @brief Listen on a UDP port for packets from any remote endpoint.
    * @param localPort local port.
    * @param localIp local interface address (ESP32 only).
    *
-   * Up to four simultaneous IPv6 EndpointIds can be tracked.
+   * Each remote endpoint is assigned an EndpointId. IPv4 endpoints are encoded directly into the
+   * EndpointId. The number of simultaneously tracked IPv6 endpoints is limited by
+   * setEndpointCapacity(); when exceeded, the least recently used endpoint is forgotten.
    */
   bool beginListen(uint16_t localPort = 6363, IPAddress localIp = IPAddress());
 
@@ -57,6 +67,26 @@ public:
    */
   bool beginTunnel(IPAddress remoteIp, uint16_t remotePort = 6363, uint16_t localPort = 6363);
 
+  /**
+   * @brief Establish a UDP tunnel to a group of routers.
+   * @param remoteIps router addresses.
+   * @param count number of routers, between 1 and @c MaxTunnelRouters .
+   * @param remotePort remote port, same for every router.
+   * @param localPort local port.
+   *
+   * Interest round-trip time is measured per router, and outgoing Interests are sent to the
+   * healthy router with the lowest smoothed RTT. A router that has not responded within the
+   * failover timeout (see setFailoverTimeout()) is marked unhealthy, and traffic fails over to
+   * another router. A small fraction of Interests is sent to other healthy routers to keep
+   * their RTT estimates current.
+   *
+   * Packets from any router in the group are accepted. When the group has more than one
+   * router, each router is assigned EndpointId 1..count, so that replies to an incoming
+   * Interest are returned to the router that forwarded it.
+   */
+  bool beginTunnel(const IPAddress* remoteIps, size_t count, uint16_t remotePort = 6363,
+                   uint16_t localPort = 6363);
+
   /**
    * @brief Join a UDP multicast group.
    * @param localIp local interface address (ESP8266 only).
@@ -67,6 +97,182 @@ public:
   /** @brief Disable the transport. */
   void end();
 
+  /** @brief Determine whether the transport is in TUNNEL mode. */
+  bool isTunnel() const {
+    return m_mode == Mode::TUNNEL;
+  }
+
+  /**
+   * @brief Retrieve path MTU toward the remote endpoint in TUNNEL mode.
+   *
+   * This is initially @c DefaultMtu , and can be updated by @c PmtuDiscovery .
+   * In TUNNEL mode, outgoing packets longer than path MTU are fragmented with NDNLPv2, so that
+   * they are not fragmented at IP layer. The remote endpoint must support NDNLPv2 reassembly.
+   */
+  size_t getPathMtu() const {
+    return m_pathMtu;
+  }
+
+  /** @brief Set path MTU, normally invoked by @c PmtuDiscovery . */
+  void setPathMtu(size_t mtu) {
+    m_pathMtu = mtu;
+  }
+
+  /**
+   * @brief Send a packet without path MTU fragmentation.
+   *
+   * This is used by @c PmtuDiscovery to send probes.
+   */
+  bool sendUnfragmented(const uint8_t* pkt, size_t pktLen) {
+    return sendPacket(pkt, pktLen, 0, false);
+  }
+
+  /**
+   * @brief Set failover timeout in TUNNEL mode.
+   * @param timeout duration in millis; default is @c DefaultFailoverTimeout .
+   *
+   * A router is considered unhealthy if it has not replied with any Data or Nack within this
+   * duration after an Interest was sent to it.
+   */
+  void setFailoverTimeout(int timeout) {
+    m_failoverTimeout = timeout;
+  }
+
+  /** @brief Retrieve index of the router currently preferred in TUNNEL mode. */
+  size_t getActiveRouter() const {
+    return m_activeRouter;
+  }
+
+  /**
+   * @brief Retrieve smoothed Interest RTT of a router in TUNNEL mode.
+   * @return RTT in millis, or -1 if unknown.
+   */
+  int getRouterRtt(size_t index) const {
+    return index < m_nRouters ? m_routers[index].srtt : -1;
+  }
+
+  /** @brief Packet I/O backend. */
+  enum class Backend : uint8_t {
+    /** @brief WiFiUDP on ESP8266 and RP2040, NetworkUDP on ESP32. */
+    NetworkUdp,
+    /**
+     * @brief lwIP raw PCB (ESP8266 and ESP32 only).
+     *
+     * Received datagrams are retained as lwIP pbufs and passed to the Face without copying.
+     * Each pbuf is released after the Face has processed the packet.
+     */
+    LwipPcb,
+  };
+
+  /**
+   * @brief Select packet I/O backend.
+   * @return whether success.
+   *
+   * This must be invoked while the transport is disabled.
+   */
+  bool setBackend(Backend backend);
+
+  /**
+   * @brief Capture received datagrams into a preallocated RX queue.
+   * @param capacity number of RX buffers, each as large as the transport MTU;
+   *                 0 disables the RX queue; maximum is @c LwipPcbRxCapacity .
+   * @return whether success.
+   *
+   * This requires LwipPcb backend, and must be invoked while the transport is disabled.
+   * Datagrams are copied out of lwIP pbufs in the lwIP callback, so that pbufs are released
+   * right away and bursts arriving between Face::loop() invocations are absorbed by the queue.
+   * They are dispatched to the Face during the next Face::loop() invocation.
+   */
+  bool setRxQueue(size_t capacity);
+
+  /**
+   * @brief Change maximum number of IPv6 remote endpoints tracked in LISTEN and MULTICAST modes.
+   * @param capacity between 1 and @c UdpEndpointTable::MaxCapacity ;
+   *                 default is @c UdpEndpointTable::DefaultCapacity .
+   * @return whether success.
+   *
+   * This must be invoked while the transport is disabled.
+   */
+  bool setEndpointCapacity(size_t capacity);
+
+  /**
+   * @brief Limit received packets processed in each Face::loop() invocation.
+   * @param maxPackets maximum number of packets, 0 means unlimited.
+   * @param maxBytes maximum total length of packets, 0 means unlimited.
+   *
+   * Packets exceeding the budget are deferred to the next Face::loop() invocation.
+   * With LwipPcb backend, pending packets are serviced in round-robin order among remote
+   * endpoints, continuing across Face::loop() invocations, so that a single sender cannot
+   * monopolize the budget.
+   */
+  void setRxBudget(size_t maxPackets, size_t maxBytes = 0);
+
+  /**
+   * @brief Queue outgoing packets for paced transmission and retry.
+   * @param capacity number of TX slots, each as large as the transport MTU; 0 disables the queue.
+   * @return whether success.
+   *
+   * This must be invoked while the transport is disabled.
+   * When enabled, a packet that cannot be sent immediately, either due to pacing or because the
+   * network stack is out of buffers, is queued and retried during subsequent Face::loop()
+   * invocations. A packet is dropped if the queue is full or after @c MaxTxRetries failed
+   * attempts. Permanent failures, such as an unknown destination, are not retried.
+   * Producers may consult getTxQueueDepth() to back off.
+   */
+  bool setTxQueue(size_t capacity);
+
+  /**
+   * @brief Limit transmission rate with a token bucket.
+   * @param packetsPerSecond maximum sustained rate, 0 means unlimited.
+   * @param burst maximum packets sent back-to-back.
+   *
+   * This requires TX queue, see setTxQueue().
+   */
+  void setTxRate(uint32_t packetsPerSecond, uint16_t burst = 1) {
+    m_txQueue.setRate(packetsPerSecond, burst);
+  }
+
+  /** @brief Return number of packets waiting in TX queue. */
+  size_t getTxQueueDepth() const {
+    return m_txQueue.size();
+  }
+
+  struct Counters {
+    /** @brief Datagrams dropped because the RX queue is full. */
+    uint32_t nRxQueueFull = 0;
+    /** @brief Datagrams dropped because they exceed the MTU. */
+    uint32_t nRxOversize = 0;
+    /** @brief Packets passed to the Face. */
+    uint32_t nRxServiced = 0;
+    /**
+     * @brief Datagrams left for the next loop because RX budget is exhausted.
+     *
+     * With LwipPcb backend, this counts every datagram still pending or queued. With NetworkUdp
+     * backend, the socket does not report its queue depth, so this counts at most one per loop.
+     */
+    uint32_t nRxDeferred = 0;
+    /** @brief Transmission attempts that failed transiently and were scheduled for retry. */
+    uint32_t nTxRetries = 0;
+    /**
+     * @brief Queued packets dropped because TX queue is full, retries are exhausted, or the
+     *        destination became invalid.
+     */
+    uint32_t nTxDropped = 0;
+    /** @brief Times the preferred router changed because it became unhealthy. */
+    uint32_t nFailovers = 0;
+    /** @brief Remote endpoint table counters. */
+    UdpEndpointTable::Counters endpoints;
+  };
+
+  /** @brief Read counters. */
+  Counters readCounters() const {
+    Counters cnt = m_cnt;
+    cnt.nRxQueueFull = m_lwipCnt.nRxQueueFull.load(std::memory_order_relaxed);
+    cnt.nRxOversize += m_lwipCnt.nRxOversize.load(std::memory_order_relaxed);
+    cnt.endpoints = m_endpoints.readCounters();
+    return cnt;
+  }
+
 private:
   bool doIsUp() const final;
 
@@ -74,10 +280,80 @@ private:
 
   bool doSend(const uint8_t* pkt, size_t pktLen, uint64_t endpointId) final;
 
+  /**
+   * @brief Send a network layer packet or LpPacket.
+   * @param canFragment whether the packet may be fragmented to fit in path MTU.
+   */
+  bool sendPacket(const uint8_t* pkt, size_t pktLen, uint64_t endpointId, bool canFragment);
+
+  /** @brief Send a frame, or queue it if TX queue is enabled. */
+  bool sendFrame(const uint8_t* pkt, size_t pktLen, uint64_t endpointId);
+
+  /**
+   * @brief Determine EndpointId of a received packet.
+   * @return whether the packet should be accepted.
+   */
+  bool acceptRemote(const IPAddress& ip, uint16_t port, uint64_t& endpointId);
+
+  /**
+   * @brief Determine destination of an outgoing packet.
+   * @return whether the destination is known.
+   */
+  bool resolveRemote(uint64_t endpointId, IPAddress& ip, uint16_t& port);
+
+  enum class TxResult : uint8_t {
+    OK,
+    Retry, ///< transient failure, such as buffer shortage
+    Fail,  ///< permanent failure, such as unknown destination
+  };
+
+  /** @brief Transmit a packet immediately. */
+  TxResult transmit(const uint8_t* pkt, size_t pktLen, uint64_t endpointId);
+
+  /** @brief Transmit queued packets as permitted by pacing. */
+  void loopTxQueue();
+
+  /**
+   * @brief Choose a router for an outgoing Interest in TUNNEL mode.
+   * @return router index.
+   */
+  size_t txTunnelInterest();
+
+  /** @brief Update RTT and health of a router upon receiving a Data or Nack from it. */
+  void rxTunnel(size_t index);
+
+  /** @brief Detect unresponsive routers and fail over if necessary. */
+  void checkTunnel();
+
+  /** @brief Choose the preferred router among healthy routers. */
+  void selectRouter();
+
+  /** @brief Pass a received packet to the Face. */
+  void receive(const uint8_t* pkt, size_t pktLen, uint64_t endpointId);
+
+  void loopNetworkUdp();
+
+  void loopRxQueue();
+
 public:
   enum {
     /** @brief Default MTU for UDP is Ethernet MTU minus IPv4 and UDP headers. */
     DefaultMtu = 1500 - 20 - 8,
+
+    /** @brief Maximum number of received datagrams queued by LwipPcb backend. */
+    LwipPcbRxCapacity = 16,
+
+    /** @brief Maximum UDP payload length over IPv4. */
+    MaxUdpPayload = 65535 - 20 - 8,
+
+    /** @brief Maximum transmission attempts of a queued packet after the first failure. */
+    MaxTxRetries = 8,
+
+    /** @brief Maximum number of routers in a tunnel group. */
+    MaxTunnelRouters = 4,
+
+    /** @brief Default failover timeout in millis. */
+    DefaultFailoverTimeout = 4000,
   };
 
   /** @brief NDN multicast group "224.0.23.170". */
@@ -91,20 +367,52 @@ private:
     MULTICAST,
   };
 
+  /**
+   * @brief Counters updated in lwIP callback.
+   *
+   * They are written by the lwIP thread only, and read from the loop task.
+   */
+  struct LwipCounters {
+    std::atomic<uint32_t> nRxQueueFull{0};
+    std::atomic<uint32_t> nRxOversize{0};
+  };
+
+  struct TunnelRouter {
+    IPAddress ip;
+    ndnph::port::Clock::Time pendingSince{}; ///< when the oldest unanswered Interest was sent
+    ndnph::port::Clock::Time downSince{};    ///< when the router was marked unhealthy
+    int srtt = -1;                           ///< smoothed RTT in millis, -1 if unknown
+    bool hasPending = false;
+    bool isDown = false;
+  };
+
   uint8_t* m_buf = nullptr;
   size_t m_bufcap = 0;
   std::unique_ptr<uint8_t[]> m_ownBuf;
 
   ESP8266NDN_NetworkUDP m_udp;
-#if LWIP_IPV6
-  using EndpointIdHelper = ndnph::port_transport_socket::Ipv6EndpointIdHelper<4>;
-#else
-  using EndpointIdHelper = ndnph::port_transport_socket::Ipv6EndpointIdHelper<1>;
-#endif
-  EndpointIdHelper m_endpoints;
-  IPAddress m_ip;      ///< remote IP in TUNNEL mode, local IP in MULTICAST mode
+  class LwipPcb;
+  std::unique_ptr<LwipPcb> m_pcb;
+  UdpEndpointTable m_endpoints;
+  UdpTxQueue m_txQueue;
+  IPAddress m_ip;      ///< local IP in MULTICAST mode
   uint16_t m_port = 0; ///< remote port in TUNNEL mode, group port in MULTICAST mode
+  TunnelRouter m_routers[MaxTunnelRouters];
+  uint8_t m_nRouters = 0;
+  uint8_t m_activeRouter = 0;
+  uint8_t m_exploreRouter = 0;
+  uint8_t m_txRouter = 0; ///< router of the most recent network layer packet
+  uint16_t m_nTunnelInterests = 0;
+  int m_failoverTimeout = DefaultFailoverTimeout;
   Mode m_mode = Mode::NONE;
+  size_t m_pathMtu = DefaultMtu;
+  std::unique_ptr<LpFragmenter> m_fragmenter;
+  size_t m_fragmenterMtu = 0;
+  size_t m_rxBudgetPackets = 0;
+  size_t m_rxBudgetBytes = 0;
+  int m_rxParsedLen = 0; ///< length of datagram parsed but not read from m_udp
+  Counters m_cnt;
+  LwipCounters m_lwipCnt;
 };
 
 } // namespace esp8266ndn
@@ -0,0 +1,87 @@
+#include "udp-tx-queue.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace esp8266ndn {
+
+bool
+UdpTxQueue::resize(size_t capacity, size_t mtu) {
+  if (mtu > UINT16_MAX) {
+    return false;
+  }
+
+  m_buf.reset(capacity == 0 ? nullptr : new uint8_t[capacity * mtu]);
+  m_items.reset(capacity == 0 ? nullptr : new Item[capacity]);
+  for (size_t i = 0; i < capacity; ++i) {
+    m_items[i].pkt = &m_buf[i * mtu];
+  }
+  m_capacity = capacity;
+  m_mtu = mtu;
+  m_head = 0;
+  m_size = 0;
+  return true;
+}
+
+bool
+UdpTxQueue::push(const uint8_t* pkt, size_t pktLen, uint64_t endpointId) {
+  if (m_size == m_capacity || pktLen > m_mtu) {
+    return false;
+  }
+
+  Item& item = m_items[(m_head + m_size) % m_capacity];
+  std::memcpy(item.pkt, pkt, pktLen);
+  item.pktLen = pktLen;
+  item.nRetries = 0;
+  item.endpointId = endpointId;
+  ++m_size;
+  return true;
+}
+
+UdpTxQueue::Item*
+UdpTxQueue::front() {
+  if (m_size == 0) {
+    return nullptr;
+  }
+  return &m_items[m_head];
+}
+
+void
+UdpTxQueue::pop() {
+  if (m_size == 0) {
+    return;
+  }
+  m_head = (m_head + 1) % m_capacity;
+  --m_size;
+}
+
+void
+UdpTxQueue::setRate(uint32_t packetsPerSecond, uint16_t burst) {
+  m_rate = packetsPerSecond;
+  m_burst = 1000 * std::max<uint32_t>(burst, 1);
+  m_tokens = m_burst;
+  m_hasRefilled = false;
+}
+
+bool
+UdpTxQueue::take(ndnph::port::Clock::Time now) {
+  if (m_rate == 0) {
+    return true;
+  }
+
+  if (m_hasRefilled) {
+    int elapsed = std::max(0, ndnph::port::Clock::sub(now, m_lastRefill));
+    uint64_t refill = static_cast<uint64_t>(elapsed) * m_rate;
+    m_tokens = static_cast<uint32_t>(std::min<uint64_t>(m_tokens + refill, m_burst));
+  }
+  m_lastRefill = now;
+  m_hasRefilled = true;
+
+  if (m_tokens < 1000) {
+    return false;
+  }
+  m_tokens -= 1000;
+  return true;
+}
+
+} // namespace esp8266ndn
@@ -0,0 +1,91 @@
+#ifndef ESP8266NDN_TRANSPORT_UDP_TX_QUEUE_HPP
+#define ESP8266NDN_TRANSPORT_UDP_TX_QUEUE_HPP
+
+#include "../port/port.hpp"
+
+namespace esp8266ndn {
+
+/**
+ * @brief Bounded queue of outgoing UDP packets with token bucket pacing.
+ *
+ * Packets are copied into preallocated slots, each as large as the MTU. Pacing is applied to
+ * transmission attempts, so that a packet that cannot be sent due to transient buffer shortage
+ * does not exceed the configured rate when retried.
+ */
+class UdpTxQueue {
+public:
+  struct Item {
+    uint8_t* pkt;
+    uint16_t pktLen;
+    uint8_t nRetries;
+    uint64_t endpointId;
+  };
+
+  size_t capacity() const {
+    return m_capacity;
+  }
+
+  /** @brief Return number of queued packets. */
+  size_t size() const {
+    return m_size;
+  }
+
+  /**
+   * @brief Change capacity.
+   * @param capacity number of slots, 0 disables the queue.
+   * @param mtu maximum packet length.
+   * @return whether success.
+   *
+   * Queued packets are discarded.
+   */
+  bool resize(size_t capacity, size_t mtu);
+
+  /**
+   * @brief Append a packet.
+   * @return whether success; false if the queue is full or the packet exceeds MTU.
+   */
+  bool push(const uint8_t* pkt, size_t pktLen, uint64_t endpointId);
+
+  /** @brief Access the oldest packet, or nullptr if the queue is empty. */
+  Item* front();
+
+  /** @brief Remove the oldest packet. */
+  void pop();
+
+  /** @brief Discard all packets. */
+  void clear() {
+    m_size = 0;
+  }
+
+  /**
+   * @brief Change pacing rate.
+   * @param packetsPerSecond token refill rate, 0 means unlimited.
+   * @param burst bucket depth, at least 1.
+   */
+  void setRate(uint32_t packetsPerSecond, uint16_t burst);
+
+  /**
+   * @brief Take a token for one transmission attempt.
+   * @param now current timestamp.
+   * @return whether a token is available.
+   */
+  bool take(ndnph::port::Clock::Time now);
+
+private:
+  std::unique_ptr<uint8_t[]> m_buf;
+  std::unique_ptr<Item[]> m_items;
+  size_t m_capacity = 0;
+  size_t m_mtu = 0;
+  size_t m_head = 0;
+  size_t m_size = 0;
+
+  uint32_t m_rate = 0;   ///< tokens per second
+  uint32_t m_burst = 0;  ///< bucket depth, in milli-tokens
+  uint32_t m_tokens = 0; ///< available milli-tokens
+  ndnph::port::Clock::Time m_lastRefill{};
+  bool m_hasRefilled = false;
+};
+
+} // namespace esp8266ndn
+
+#endif // ESP8266NDN_TRANSPORT_UDP_TX_QUEUE_HPP